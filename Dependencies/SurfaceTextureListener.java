@@ -0,0 +1,36 @@
+import android.graphics.SurfaceTexture;
+import android.os.Handler;
+import android.os.HandlerThread;
+
+public class SurfaceTextureListener implements SurfaceTexture.OnFrameAvailableListener {
+    private static Handler handler;
+    private final long id;
+
+    public SurfaceTextureListener(SurfaceTexture surfaceTexture, long id)
+    {
+        this.id = id;
+        surfaceTexture.setOnFrameAvailableListener(this, getHandler());
+    }
+
+    // Notifications arrive on a dedicated thread, so they are still delivered while the thread that created the
+    // SurfaceTexture is blocked waiting for a frame.
+    private static synchronized Handler getHandler()
+    {
+        if (handler == null)
+        {
+            HandlerThread thread = new HandlerThread("SurfaceTextureListener");
+            thread.start();
+            handler = new Handler(thread.getLooper());
+        }
+
+        return handler;
+    }
+
+    @Override
+    public void onFrameAvailable(SurfaceTexture surfaceTexture)
+    {
+        frameAvailableCallback(this.id);
+    }
+
+    public static native void frameAvailableCallback(long id);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "AssetArchiveFormat.h"
+#include "Assets.h"
+#include <string_view>
+#include <vector>
+
+namespace android::Assets
+{
+    // Reads an archive produced by Tools/AssetPacker. The archive is mapped once through the asset's file descriptor,
+    // so it has to be stored uncompressed in the APK (for example through androidResources.noCompress).
+    class AssetArchive final
+    {
+    public:
+        AssetArchive(AAssetManager* assetManager, const char* path);
+
+        bool Contains(std::string_view path) const;
+
+        std::optional<Archive::Entry> Find(std::string_view path) const;
+
+        // Zero-copy view of an entry that is stored uncompressed. Throws if the entry is missing or compressed.
+        gsl::span<const std::byte> GetData(std::string_view path) const;
+
+        // Returns the uncompressed contents of an entry, decompressing and verifying it as needed.
+        std::vector<std::byte> Read(std::string_view path) const;
+
+        size_t EntryCount() const;
+
+        Archive::Entry GetEntry(size_t index) const;
+
+    private:
+        Archive::Entry GetRequiredEntry(std::string_view path) const;
+
+        Asset m_asset;
+        Archive::Reader m_reader;
+    };
+}
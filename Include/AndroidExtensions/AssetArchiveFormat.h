@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// Platform independent description of the packed asset archive format, shared by the runtime reader and the
+// host side packer in Tools/AssetPacker. All values are little endian.
+//
+//   Header
+//   EntryRecord[EntryCount]   sorted by path, compared bytewise
+//   path table                UTF-8 paths without terminators, '/' separated
+//   data blobs                each starting at a multiple of Header::Alignment
+namespace android::Assets::Archive
+{
+    constexpr uint32_t MAGIC{0x52415841}; // "AXAR"
+    constexpr uint16_t VERSION{1};
+
+    enum class Compression : uint32_t
+    {
+        None = 0,
+        LZ4 = 1, // A single LZ4 block, without frame.
+    };
+
+    struct Header
+    {
+        uint32_t Magic;
+        uint16_t Version;
+        uint16_t Reserved;
+        uint32_t EntryCount;
+        uint32_t Alignment;
+        uint64_t EntryTableOffset;
+        uint64_t PathTableOffset;
+    };
+
+    static_assert(sizeof(Header) == 32);
+
+    struct EntryRecord
+    {
+        uint32_t PathOffset; // Relative to the start of the path table.
+        uint32_t PathLength;
+        uint64_t DataOffset; // Relative to the start of the archive.
+        uint64_t StoredSize;
+        uint64_t Size;
+        Archive::Compression Compression;
+        uint32_t Checksum; // CRC-32 of the uncompressed data.
+    };
+
+    static_assert(sizeof(EntryRecord) == 40);
+
+    uint32_t Crc32(const std::byte* data, size_t size);
+
+    // Returns the compressed data, or an empty vector if compression would not make the data smaller.
+    std::vector<std::byte> CompressLZ4(const std::byte* source, size_t sourceSize);
+
+    // Returns false if the block is malformed or does not decompress to exactly destinationSize bytes.
+    bool DecompressLZ4(const std::byte* source, size_t sourceSize, std::byte* destination, size_t destinationSize);
+
+    struct Entry
+    {
+        std::string_view Path;
+        const std::byte* Data;
+        uint64_t StoredSize;
+        uint64_t Size;
+        Archive::Compression Compression;
+        uint32_t Checksum;
+    };
+
+    // Validates and indexes an archive that is already in memory. Does not copy or take ownership of the data.
+    class Reader final
+    {
+    public:
+        Reader(const std::byte* data, size_t size);
+
+        size_t EntryCount() const;
+
+        Entry GetEntry(size_t index) const;
+
+        std::optional<Entry> Find(std::string_view path) const;
+
+        // Writes the uncompressed contents of the entry to destination, which must hold entry.Size bytes, and
+        // verifies the checksum. Throws if the entry is corrupt.
+        static void Extract(const Entry& entry, std::byte* destination);
+
+        static bool VerifyChecksum(const Entry& entry);
+
+    private:
+        // Records are copied out rather than dereferenced in place, since the archive is only guaranteed
+        // to be 4 byte aligned inside the APK.
+        EntryRecord GetRecord(size_t index) const;
+
+        const std::byte* m_data;
+        size_t m_size;
+        const std::byte* m_records;
+        uint32_t m_entryCount;
+        const char* m_paths;
+    };
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Assets.h"
+#include "JavaThreadPool.h"
+#include "JavaWrappers.h"
+#include "MemoryPressure.h"
+#include <arcana/threading/task.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace android::Assets
+{
+    // Size-bounded LRU cache of assets that are read ahead of use on background threads. The cache is registered
+    // with MemoryPressure so it sheds its least recently used assets when the system is low on memory.
+    class AssetCache final
+    {
+    public:
+        using AssetPtr = std::shared_ptr<const Asset>;
+
+        AssetCache(const content::res::AssetManager& assetManager, JavaThreadPool& threadPool, size_t capacity, int32_t trimPriority = 0);
+        ~AssetCache();
+
+        AssetCache(const AssetCache&) = delete;
+        AssetCache& operator=(const AssetCache&) = delete;
+
+        // Returns the cached asset, loading it in the background if needed. Concurrent loads of the same
+        // path share a single read.
+        arcana::task<AssetPtr, std::exception_ptr> LoadAsync(const std::string& path);
+
+        // Loads all of the given assets into the cache. The task fails if any of them cannot be loaded.
+        arcana::task<void, std::exception_ptr> PrefetchAsync(const std::vector<std::string>& paths);
+
+        // Returns the asset if it is cached and marks it as recently used, or nullptr otherwise. Never blocks on a load.
+        AssetPtr TryGet(const std::string& path);
+
+        // Evicts least recently used assets until at least the given number of bytes has been released.
+        // Assets still referenced by callers stay alive until they are released.
+        size_t Trim(size_t bytesToRelease);
+
+        size_t Size() const;
+
+        size_t Capacity() const;
+
+    private:
+        struct State;
+        std::shared_ptr<State> m_state;
+        MemoryPressure::CacheTicket m_cacheTicket;
+    };
+}
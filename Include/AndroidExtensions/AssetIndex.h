@@ -0,0 +1,64 @@
+#pragma once
+
+#include "JavaWrappers.h"
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace android::Assets
+{
+    // In-memory index of the APK asset tree, so existence and size queries do not have to open assets.
+    // Directories are indexed the first time a path inside them is queried, or all at once with IndexAll.
+    class AssetIndex final
+    {
+    public:
+        struct Entry
+        {
+            uint64_t Size;
+            bool Compressed;
+        };
+
+        AssetIndex(const content::res::AssetManager& assetManager);
+        ~AssetIndex();
+
+        AssetIndex(const AssetIndex&) = delete;
+        AssetIndex& operator=(const AssetIndex&) = delete;
+
+        // Recursively indexes every asset below the given directory ("" for the root of the asset tree).
+        void IndexAll(const std::string& root = "");
+
+        std::optional<Entry> Find(std::string_view path);
+
+        bool Exists(std::string_view path);
+
+        // Returns the sorted paths of all indexed assets that start with the prefix. Only the directory containing the
+        // prefix is indexed on demand, so call IndexAll first to include nested directories.
+        std::vector<std::string> Enumerate(std::string_view prefix);
+
+        // Returns the sorted paths of indexed assets matching the pattern, where '?' matches one character, '*' matches
+        // any characters within a path segment and '**' matches across segments. Indexing follows the same rules as Enumerate.
+        std::vector<std::string> Glob(std::string_view pattern);
+
+    private:
+        // Must be called with m_mutex held exclusively.
+        void IndexDirectory(const std::string& directory);
+
+        void EnsureDirectoryIndexed(std::string_view directory);
+
+        jobject m_assetManagerRef;
+        AAssetManager* m_assetManager;
+
+        std::shared_mutex m_mutex{};
+
+        // Ordered storage for prefix queries; the hash map holds views of its keys for constant time lookups.
+        std::map<std::string, Entry, std::less<>> m_entries{};
+        std::unordered_map<std::string_view, const Entry*> m_lookup{};
+        std::unordered_set<std::string> m_indexedDirectories{};
+    };
+}
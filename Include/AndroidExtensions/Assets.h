@@ -0,0 +1,61 @@
+#pragma once
+
+#include <android/asset_manager.h>
+#include <gsl/gsl>
+#include <cstddef>
+
+namespace android::Assets
+{
+    // Describes how an asset is going to be accessed, which determines how its contents are exposed.
+    enum class AccessMode
+    {
+        // Uncompressed assets are memory mapped and paged in on demand; compressed assets are decompressed in full.
+        Random,
+
+        // Uncompressed assets are memory mapped with a sequential readahead hint; compressed assets are not
+        // decompressed up front and are only available through Read.
+        Streaming,
+
+        // The whole contents are needed right away. Uncompressed assets are served directly from the mapped APK.
+        Buffer,
+    };
+
+    // Owns an open AAsset and exposes its contents without copying them into a separate heap allocation.
+    class Asset final
+    {
+    public:
+        Asset(AAssetManager* assetManager, const char* path, AccessMode mode = AccessMode::Buffer);
+        ~Asset();
+
+        Asset(const Asset&) = delete;
+        Asset& operator=(const Asset&) = delete;
+
+        Asset(Asset&&) noexcept;
+        Asset& operator=(Asset&&) noexcept;
+
+        size_t Size() const;
+
+        bool IsCompressed() const;
+
+        // The full contents of the asset, valid for the lifetime of this object. Empty for compressed assets
+        // opened in streaming mode, which must be consumed with Read instead.
+        gsl::span<const std::byte> Data() const;
+
+        // Copies up to buffer.size() bytes from the current read position and returns the number of bytes read.
+        size_t Read(gsl::span<std::byte> buffer);
+
+        // Asks the kernel to start paging in a mapped asset ahead of use. Has no effect on unmapped assets.
+        void Prefetch() const;
+
+    private:
+        void Close();
+
+        AAsset* m_asset{};
+        void* m_mapping{};
+        size_t m_mappingSize{};
+        const std::byte* m_data{};
+        size_t m_size{};
+        size_t m_position{};
+        bool m_compressed{};
+    };
+}
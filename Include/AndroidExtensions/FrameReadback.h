@@ -0,0 +1,103 @@
+#pragma once
+
+#include "GLWorkerPool.h"
+#include <gsl/gsl>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace android::OpenGLHelpers
+{
+    // Copies frames of a camera or video texture to the CPU without stalling the GL thread. Each captured frame is
+    // drawn into an offscreen target, optionally scaled and converted, and read into one of a ring of pixel pack
+    // buffers. Frames are handed to the callback once the GPU has finished them, typically one or two frames later.
+    // All methods must be called on the thread with the OpenGL ES context current.
+    class FrameReadback final
+    {
+    public:
+        enum class PixelFormat
+        {
+            // Four bytes per pixel.
+            RGBA,
+
+            // One byte of BT.601 luma per pixel, computed on the GPU. The width must be a multiple of four.
+            Luminance,
+        };
+
+        // Rows are delivered top to bottom and tightly packed. The pixels are only valid during the callback.
+        struct Frame
+        {
+            gsl::span<const std::byte> Pixels;
+            GLsizei Width;
+            GLsizei Height;
+            size_t RowStride;
+            int64_t Timestamp;
+        };
+
+        using FrameCallback = std::function<void(const Frame&)>;
+
+        struct Statistics
+        {
+            uint64_t Captured;
+            uint64_t Delivered;
+            uint64_t Dropped;
+        };
+
+        // Frames are scaled to width by height. sourceTarget is GL_TEXTURE_EXTERNAL_OES for SurfaceTexture frames, or
+        // GL_TEXTURE_2D to read back ordinary textures.
+        FrameReadback(GLsizei width, GLsizei height, PixelFormat format, FrameCallback callback, size_t ringSize = 3,
+            GLenum sourceTarget = GL_TEXTURE_EXTERNAL_OES);
+
+        // Frames still in flight are discarded.
+        ~FrameReadback();
+
+        FrameReadback(const FrameReadback&) = delete;
+        FrameReadback& operator=(const FrameReadback&) = delete;
+
+        // Delivers finished frames, then draws the texture and starts reading it back. transformMatrix is the column
+        // major texture coordinate transform from SurfaceTexture.getTransformMatrix, or null for identity. When every
+        // buffer in the ring is still in flight the frame is dropped rather than waiting on the GPU.
+        void Capture(GLuint texture, const float* transformMatrix = nullptr, int64_t timestamp = 0);
+
+        // Delivers finished frames without capturing a new one.
+        void Poll();
+
+        Statistics GetStatistics() const;
+
+    private:
+        struct Slot
+        {
+            GLuint Buffer{};
+            OpenGLHelpers::Fence Fence{};
+            int64_t Timestamp{};
+        };
+
+        void Destroy();
+
+        const GLsizei m_width;
+        const GLsizei m_height;
+        const PixelFormat m_format;
+        const GLenum m_sourceTarget;
+        const FrameCallback m_callback;
+
+        // Size of the render target, which is a quarter of the width when four luma values are packed per texel.
+        const GLsizei m_targetWidth;
+
+        GLuint m_program{};
+        GLint m_transformLocation{-1};
+        GLuint m_vertexArray{};
+        GLuint m_texture{};
+        GLuint m_framebuffer{};
+
+        std::vector<Slot> m_slots{};
+        size_t m_nextSlot{};
+
+        // Indices of slots with a readback in flight, oldest first, so frames are delivered in capture order.
+        std::deque<size_t> m_inFlight{};
+
+        uint64_t m_captured{};
+        uint64_t m_delivered{};
+        uint64_t m_dropped{};
+    };
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "OpenGLHelpers.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace android::OpenGLHelpers
+{
+    // Owns a GL fence sync object. Insert one after producing GL objects on one context and test or wait for it on
+    // another, so results are only used once the GPU work behind them has completed.
+    class Fence final
+    {
+    public:
+        Fence() = default;
+        ~Fence();
+
+        Fence(const Fence&) = delete;
+        Fence& operator=(const Fence&) = delete;
+
+        Fence(Fence&&) noexcept;
+        Fence& operator=(Fence&&) noexcept;
+
+        // Inserts a fence into the command stream of the current context and flushes it, which is required for
+        // other contexts to ever see the fence signaled.
+        static Fence Insert();
+
+        explicit operator bool() const;
+
+        // Returns whether the fence has been signaled, without blocking.
+        bool IsSignaled() const;
+
+        // Blocks the calling thread until the fence is signaled or the timeout expires. Returns whether it was signaled.
+        bool ClientWait(std::chrono::nanoseconds timeout) const;
+
+        // Makes the GPU commands issued afterwards on the current context wait for the fence, without blocking the
+        // calling thread.
+        void Wait() const;
+
+    private:
+        explicit Fence(GLsync sync);
+
+        GLsync m_sync{};
+    };
+
+    // Threads that each own an EGL context sharing objects with a given context, so GL work such as texture uploads
+    // and shader compiles can run off the render thread. Workers use surfaceless contexts when the display supports
+    // EGL_KHR_surfaceless_context, and 1x1 pbuffers otherwise. Satisfies the arcana scheduler concept; work runs with
+    // the worker's context current and should hand its results back with a Fence.
+    class GLWorkerPool final
+    {
+    public:
+        // Throws if a context cannot be created or made current.
+        GLWorkerPool(EGLDisplay display, EGLContext shareContext, size_t threadCount = 1, std::string name = "GLWorkerPool");
+        ~GLWorkerPool();
+
+        GLWorkerPool(const GLWorkerPool&) = delete;
+        GLWorkerPool& operator=(const GLWorkerPool&) = delete;
+
+        template<typename CallableT>
+        void operator()(CallableT&& callable)
+        {
+            if constexpr (std::is_copy_constructible_v<std::decay_t<CallableT>>)
+            {
+                Enqueue(std::forward<CallableT>(callable));
+            }
+            else
+            {
+                // std::function requires copyable targets, so move-only continuations are shared instead.
+                auto shared{std::make_shared<std::decay_t<CallableT>>(std::forward<CallableT>(callable))};
+                Enqueue([shared]() { (*shared)(); });
+            }
+        }
+
+        size_t QueueDepth() const;
+
+    private:
+        using Work = std::function<void()>;
+
+        struct Worker final
+        {
+            EGLContext Context{EGL_NO_CONTEXT};
+            EGLSurface Surface{EGL_NO_SURFACE};
+            std::thread Thread{};
+        };
+
+        void Enqueue(Work&& work);
+        void Run(Worker& worker, size_t index);
+        void Destroy();
+
+        const EGLDisplay m_display;
+        const std::string m_name;
+        std::vector<std::unique_ptr<Worker>> m_workers{};
+
+        mutable std::mutex m_mutex{};
+        std::condition_variable m_condition{};
+        std::deque<Work> m_queue{};
+        bool m_stopping{};
+
+        // Workers report whether they could make their context current before the constructor returns.
+        size_t m_started{};
+        std::string m_startError{};
+    };
+}
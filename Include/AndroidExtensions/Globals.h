@@ -1,31 +1,83 @@
 #pragma once
 
 #include <jni.h>
-#include <arcana/containers/ticketed_collection.h>
+#include <functional>
 #include "JavaWrappers.h"
 
 namespace android::global
 {
+    // Keeps a registered callback alive. The callback is unregistered when the ticket is destroyed,
+    // which is safe to do from any thread, including from inside the callback while it is being fired.
+    class CallbackTicket final
+    {
+    public:
+        explicit CallbackTicket(std::function<void()> unregister);
+        ~CallbackTicket();
+
+        CallbackTicket(const CallbackTicket&) = delete;
+        CallbackTicket& operator=(const CallbackTicket&) = delete;
+
+        CallbackTicket(CallbackTicket&&) noexcept;
+        CallbackTicket& operator=(CallbackTicket&&) noexcept;
+
+    private:
+        std::function<void()> m_unregister;
+    };
+
+    // Delivers a callback on some other execution context. Any arcana scheduler can be adapted with
+    // [&scheduler](std::function<void()>&& callback) { scheduler(std::move(callback)); }.
+    using CallbackDispatcher = std::function<void(std::function<void()>&&)>;
+
     void Initialize(JavaVM* javaVM, jobject appContext);
 
     JNIEnv* GetEnvForCurrentThread();
 
+    // Attaches the current thread to the Java VM under the given name, so it can be identified in traces.
+    // The thread is detached automatically when it exits. Has no effect if the thread is already attached.
+    JNIEnv* AttachCurrentThread(const char* threadName, bool asDaemon = false);
+
+    // Detaches the current thread if it was attached by this library.
+    void DetachCurrentThread();
+
+    struct ThreadAttachStatistics
+    {
+        uint64_t Attaches;
+        uint64_t Detaches;
+    };
+
+    ThreadAttachStatistics GetThreadAttachStatistics();
+
     android::content::Context GetAppContext();
 
     android::app::Activity GetCurrentActivity();
     void SetCurrentActivity(jobject currentActivity);
     using AppStateChangedCallback = std::function<void()>;
-    using AppStateChangedCallbackTicket = arcana::ticketed_collection<AppStateChangedCallback>::ticket;
+    using AppStateChangedCallbackTicket = CallbackTicket;
 
+    // Callbacks are invoked on the firing thread unless a dispatcher is supplied, in which case the firing thread
+    // only hands the callback to the dispatcher and does not wait for it to run.
     void Pause();
     AppStateChangedCallbackTicket AddPauseCallback(std::function<void()>&&);
+    AppStateChangedCallbackTicket AddPauseCallback(std::function<void()>&&, CallbackDispatcher);
 
     void Resume();
     AppStateChangedCallbackTicket AddResumeCallback(std::function<void()>&&);
+    AppStateChangedCallbackTicket AddResumeCallback(std::function<void()>&&, CallbackDispatcher);
 
     using RequestPermissionsResultCallback = std::function<void(int32_t, const std::vector<std::string>&, const std::vector<int32_t>&)>;
-    using RequestPermissionsResultCallbackTicket = arcana::ticketed_collection<RequestPermissionsResultCallback>::ticket;
+    using RequestPermissionsResultCallbackTicket = CallbackTicket;
 
     void RequestPermissionsResult(int32_t, const std::vector<std::string>&, const std::vector<int32_t>&);
     RequestPermissionsResultCallbackTicket AddRequestPermissionsResultCallback(RequestPermissionsResultCallback&&);
+    RequestPermissionsResultCallbackTicket AddRequestPermissionsResultCallback(RequestPermissionsResultCallback&&, CallbackDispatcher);
+
+    // Forward ComponentCallbacks2.onTrimMemory levels unchanged to TrimMemory, and onLowMemory to LowMemory,
+    // which fires the trim memory callbacks with TRIM_MEMORY_COMPLETE.
+    using TrimMemoryCallback = std::function<void(int32_t)>;
+    using TrimMemoryCallbackTicket = CallbackTicket;
+
+    void TrimMemory(int32_t level);
+    void LowMemory();
+    TrimMemoryCallbackTicket AddTrimMemoryCallback(TrimMemoryCallback&&);
+    TrimMemoryCallbackTicket AddTrimMemoryCallback(TrimMemoryCallback&&, CallbackDispatcher);
 }
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace android
+{
+    // Fixed-size pool of threads that are attached to the Java VM once for their whole lifetime, so blocking
+    // Java calls can be moved off the calling thread without paying for an attach/detach per task.
+    // Satisfies the arcana scheduler concept and can be passed anywhere a scheduler is expected.
+    class JavaThreadPool final
+    {
+    public:
+        struct Statistics
+        {
+            size_t QueueDepth;
+            uint64_t Executed;
+            uint64_t Stolen;
+        };
+
+        // Each task runs inside its own JNI local reference frame with room for localFrameCapacity references.
+        JavaThreadPool(size_t threadCount, std::string name = "JavaThreadPool", int localFrameCapacity = 16);
+        ~JavaThreadPool();
+
+        JavaThreadPool(const JavaThreadPool&) = delete;
+        JavaThreadPool& operator=(const JavaThreadPool&) = delete;
+
+        template<typename CallableT>
+        void operator()(CallableT&& callable)
+        {
+            if constexpr (std::is_copy_constructible_v<std::decay_t<CallableT>>)
+            {
+                Enqueue(std::forward<CallableT>(callable));
+            }
+            else
+            {
+                // std::function requires copyable targets, so move-only continuations are shared instead.
+                auto shared{std::make_shared<std::decay_t<CallableT>>(std::forward<CallableT>(callable))};
+                Enqueue([shared]() { (*shared)(); });
+            }
+        }
+
+        size_t QueueDepth() const;
+
+        Statistics GetStatistics() const;
+
+    private:
+        using Work = std::function<void()>;
+
+        struct Worker final
+        {
+            std::mutex Mutex{};
+            std::deque<Work> Queue{};
+            std::thread Thread{};
+        };
+
+        void Enqueue(Work&& work);
+        bool TryDequeue(size_t index, Work& work);
+        void Run(size_t index);
+
+        const std::string m_name;
+        const int m_localFrameCapacity;
+        std::vector<std::unique_ptr<Worker>> m_workers{};
+
+        std::mutex m_idleMutex{};
+        std::condition_variable m_idleCondition{};
+        bool m_stopping{};
+
+        std::atomic<size_t> m_pending{};
+        std::atomic<size_t> m_nextWorker{};
+        std::atomic<uint64_t> m_executed{};
+        std::atomic<uint64_t> m_stolen{};
+    };
+}
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <jni.h>
+#include <chrono>
 #include <string>
 #include <vector>
 #include <cstddef>
+#include <memory>
 #include <android/asset_manager.h>
 #include <android/native_window.h>
+#include <android/surface_texture.h>
 #include <utility>
 
 // --------------------
@@ -16,6 +19,7 @@ namespace java::lang
 {
     class ByteArray;
     class Object;
+    class SecurityException;
     class String;
     class Throwable;
 }
@@ -28,6 +32,7 @@ namespace java::websocket
 namespace java::io
 {
     class ByteArrayOutputStream;
+    class IOException;
     class InputStream;
     class OutputStream;
     class OutputStreamWriter;
@@ -36,6 +41,8 @@ namespace java::io
 namespace java::net
 {
     class HttpURLConnection;
+    class SocketTimeoutException;
+    class URISyntaxException;
     class URL;
     class URLConnection;
 }
@@ -52,6 +59,7 @@ namespace android::app
 
 namespace android::content
 {
+    class ContentResolver;
     class Context;
 }
 
@@ -67,6 +75,11 @@ namespace android::net
     class Uri;
 }
 
+namespace android::os
+{
+    class ParcelFileDescriptor;
+}
+
 // ------------
 // Declarations
 // ------------
@@ -157,19 +170,44 @@ namespace java::lang
         jstring m_string;
     };
 
-    class Throwable : public Object, public std::exception
+    // Returns a global reference to a Java string with the given contents. The string is created the
+    // first time a value is requested and lives for the rest of the process, so callers must not delete it.
+    jstring InternString(const char* string);
+
+    // Compile-time keyed variant of InternString. KeyT must expose a static constexpr const char* Value.
+    // After the first call for a given key the lookup is a read of a function-local static.
+    template<typename KeyT>
+    jstring InternedString()
+    {
+        static const jstring string{InternString(KeyT::Value)};
+        return string;
+    }
+
+    // C++ exception wrapping a Java throwable. Only a global reference to the throwable is captured when
+    // it is thrown; the class name and message are fetched from Java the first time they are needed.
+    // Copies share the same reference, so rethrowing does not touch JNI.
+    class Throwable : public std::exception
     {
     public:
         Throwable(jthrowable throwable);
-        ~Throwable();
+
+        operator jthrowable() const;
 
         String GetMessage() const;
 
+        std::string GetClassName() const;
+
         const char* what() const noexcept override;
 
     private:
-        jobject m_throwableRef;
-        std::string m_message;
+        struct Details;
+        std::shared_ptr<Details> m_details;
+    };
+
+    class SecurityException : public Throwable
+    {
+    public:
+        using Throwable::Throwable;
     };
 }
 
@@ -206,6 +244,12 @@ namespace java::websocket
 
 namespace java::io
 {
+    class IOException : public lang::Throwable
+    {
+    public:
+        using Throwable::Throwable;
+    };
+
     class ByteArrayOutputStream : public lang::Object
     {
     public:
@@ -247,6 +291,18 @@ namespace java::io
 
 namespace java::net
 {
+    class SocketTimeoutException : public io::IOException
+    {
+    public:
+        using IOException::IOException;
+    };
+
+    class URISyntaxException : public lang::Throwable
+    {
+    public:
+        using Throwable::Throwable;
+    };
+
     class HttpURLConnection : public lang::Object
     {
     public:
@@ -304,8 +360,24 @@ namespace android
     class ManifestPermission
     {
     public:
+        enum class Permission
+        {
+            Camera,
+            RecordAudio,
+            ReadExternalStorage,
+            WriteExternalStorage,
+            AccessCoarseLocation,
+            AccessFineLocation,
+        };
+
         static jstring CAMERA();
 
+        // Returns a global reference to the Java name of the permission. All names are read from
+        // android.Manifest.permission the first time any of them is needed.
+        static jstring Get(Permission permission);
+
+        static const std::string& GetName(Permission permission);
+
     private:
         static jstring getPermissionName(const char* permissionName);
     };
@@ -319,6 +391,8 @@ namespace android::app
         Activity(jobject object);
 
         void requestPermissions(jstring systemPermissionName, int permissionRequestID);
+
+        void requestPermissions(const std::vector<std::string>& systemPermissionNames, int permissionRequestID);
     };
 }
 
@@ -333,17 +407,40 @@ namespace android::content
 
         res::AssetManager getAssets() const;
 
+        ContentResolver getContentResolver() const;
+
         res::Resources getResources();
 
         template<typename ServiceT>
         ServiceT getSystemService()
         {
-            return {getSystemService(ServiceT::ServiceName)};
+            return {getSystemService(java::lang::InternedString<ServiceNameKey<ServiceT>>())};
         };
 
         jobject getSystemService(const char* serviceName);
 
+        jobject getSystemService(jstring serviceName);
+
         bool checkSelfPermission(jstring systemPermissionName);
+
+        bool checkSelfPermission(ManifestPermission::Permission permission);
+
+        std::vector<bool> checkSelfPermission(const std::vector<ManifestPermission::Permission>& permissions);
+
+    private:
+        template<typename ServiceT>
+        struct ServiceNameKey
+        {
+            static constexpr const char* Value{ServiceT::ServiceName};
+        };
+    };
+
+    class ContentResolver : public java::lang::Object
+    {
+    public:
+        ContentResolver(jobject object);
+
+        os::ParcelFileDescriptor openFileDescriptor(const net::Uri& uri, const char* mode) const;
     };
 }
 
@@ -355,6 +452,9 @@ namespace android::content::res
         AssetManager(jobject object);
 
         operator AAssetManager*() const;
+
+        // Names of the files and directories directly inside the given asset directory.
+        std::vector<std::string> list(const char* path) const;
     };
 
     class Resources : public java::lang::Object
@@ -374,15 +474,74 @@ namespace android::content::res
     };
 }
 
+namespace android::os
+{
+    class ParcelFileDescriptor : public java::lang::Object
+    {
+    public:
+        ParcelFileDescriptor(jobject object);
+
+        // Transfers ownership of the native file descriptor to the caller, who becomes responsible for closing it.
+        int detachFd();
+    };
+}
+
 namespace android::graphics
 {
+    // Per-frame calls go through the NDK ASurfaceTexture API when the device provides it (API level 28), and fall back
+    // to JNI otherwise.
+    //
+    // Once InitializeJavaSurfaceTextureListenerClass has been called with the Dependencies/SurfaceTextureListener.java
+    // class, textures track frame availability, so callers can skip updateTexImage until the producer has queued a
+    // new frame. Without the listener class every frame is reported as new.
     class SurfaceTexture : public java::lang::Object
     {
     public:
+        struct FrameStatistics
+        {
+            // Frames queued by the producer.
+            uint64_t Available;
+
+            // Frames replaced by a newer one before updateTexImage latched them.
+            uint64_t Dropped;
+
+            // updateTexImage calls made without a new frame.
+            uint64_t Duplicated;
+        };
+
         SurfaceTexture();
         void InitWithTexture(int texture);
+
+        // Copies of the wrapper share the frame state, so only one of them should call this per frame.
         void updateTexImage() const;
+
         void setDefaultBufferSize(int width, int height);
+
+        // Timestamp of the current texture image, in nanoseconds.
+        int64_t getTimestamp() const;
+
+        // Column major 4x4 texture coordinate transform of the current texture image.
+        void getTransformMatrix(float matrix[16]) const;
+
+        // Whether a frame was queued since the last updateTexImage. Does not block.
+        bool hasNewFrame() const;
+
+        // Blocks until a frame was queued since the last updateTexImage, or the timeout expires. Returns hasNewFrame().
+        bool waitForFrame(std::chrono::milliseconds timeout) const;
+
+        FrameStatistics getFrameStatistics() const;
+
+        static void InitializeJavaSurfaceTextureListenerClass(jclass listenerClass, JNIEnv* env);
+        static void DestructJavaSurfaceTextureListenerClass(JNIEnv* env);
+
+    private:
+        struct FrameState;
+
+        static void OnFrameAvailable(JNIEnv* env, jclass cls, jlong id);
+        static jclass s_listenerClass;
+
+        std::shared_ptr<ASurfaceTexture> m_surfaceTexture{};
+        std::shared_ptr<FrameState> m_frameState{};
     };
 }
 
@@ -423,6 +582,8 @@ namespace android::net
 
         java::lang::String getPath() const;
 
+        java::lang::String toString() const;
+
         static Uri Parse(java::lang::String uriString);
     };
 }
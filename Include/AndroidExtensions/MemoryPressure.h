@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Globals.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace android::MemoryPressure
+{
+    // Levels reported by ComponentCallbacks2.onTrimMemory.
+    enum class TrimLevel : int32_t
+    {
+        RunningModerate = 5,
+        RunningLow = 10,
+        RunningCritical = 15,
+        UiHidden = 20,
+        Background = 40,
+        Moderate = 60,
+        Complete = 80,
+    };
+
+    // Returns the number of bytes currently held by a cache.
+    using CacheSizeCallback = std::function<size_t()>;
+
+    // Asks a cache to release at least the given number of bytes and returns how many it actually released.
+    using CacheTrimCallback = std::function<size_t(size_t)>;
+
+    using CacheTicket = global::CallbackTicket;
+
+    struct CacheInfo
+    {
+        std::string Name;
+        int32_t Priority;
+        size_t Bytes;
+    };
+
+    // Registers a native cache so it is trimmed when the system reports memory pressure. Caches with a lower
+    // priority are shed first. The callbacks may be invoked from any thread and must be thread safe. Releasing the
+    // ticket waits for callbacks running on other threads, so they must not wait on the thread releasing it.
+    CacheTicket RegisterCache(std::string name, int32_t priority, CacheSizeCallback&& getSize, CacheTrimCallback&& trim);
+
+    size_t GetTotalCachedBytes();
+
+    std::vector<CacheInfo> GetCaches();
+
+    // Trims registered caches in priority order until at least the given number of bytes has been released.
+    // Returns the number of bytes released.
+    size_t Trim(size_t bytesToRelease);
+
+    // Trims the share of the cached bytes that corresponds to the given trim level.
+    size_t Trim(TrimLevel level);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "JavaWrappers.h"
+#include "UriParser.h"
+#include <gsl/gsl>
+#include <cstddef>
+#include <cstdint>
+
+namespace android
+{
+    // Expected access pattern, forwarded to the kernel as readahead hints.
+    enum class ReadPattern
+    {
+        Normal,
+        Sequential,
+        Random,
+    };
+
+    // Owns a native file descriptor, so the contents of user picked files can be read without copying them through
+    // Java streams.
+    class NativeFile final
+    {
+    public:
+        // A read-only memory mapping of part of a file, unmapped when destroyed.
+        class Mapping final
+        {
+        public:
+            Mapping(const NativeFile& file, uint64_t offset, size_t length, ReadPattern pattern);
+            ~Mapping();
+
+            Mapping(const Mapping&) = delete;
+            Mapping& operator=(const Mapping&) = delete;
+
+            Mapping(Mapping&&) noexcept;
+            Mapping& operator=(Mapping&&) noexcept;
+
+            gsl::span<const std::byte> Data() const;
+
+        private:
+            void* m_mapping{};
+            size_t m_mappingSize{};
+            const std::byte* m_data{};
+            size_t m_size{};
+        };
+
+        // Opens file:// Uris directly and content:// Uris through ContentResolver.openFileDescriptor.
+        static NativeFile Open(const net::Uri& uri);
+
+        // As above, but file:// Uris are opened without creating any Java objects.
+        static NativeFile Open(const net::ParsedUri& uri);
+
+        explicit NativeFile(int fd);
+        ~NativeFile();
+
+        NativeFile(const NativeFile&) = delete;
+        NativeFile& operator=(const NativeFile&) = delete;
+
+        NativeFile(NativeFile&&) noexcept;
+        NativeFile& operator=(NativeFile&&) noexcept;
+
+        int Descriptor() const;
+
+        // Size of the file, or 0 for descriptors that are not backed by a regular file, such as pipes.
+        uint64_t Size() const;
+
+        // Reads at the given offset without moving the file position, until the buffer is full or the end of the
+        // file is reached. Returns the number of bytes read.
+        size_t Read(uint64_t offset, gsl::span<std::byte> buffer) const;
+
+        // Maps length bytes starting at offset; a length of 0 maps through the end of the file.
+        Mapping Map(uint64_t offset = 0, size_t length = 0, ReadPattern pattern = ReadPattern::Normal) const;
+
+        // Applies a readahead hint to a range of the file; a length of 0 extends to the end of the file.
+        void Advise(ReadPattern pattern, uint64_t offset = 0, uint64_t length = 0) const;
+
+        // Asks the kernel to start reading a range of the file into the page cache ahead of use.
+        void Prefetch(uint64_t offset, uint64_t length) const;
+
+    private:
+        int m_fd{-1};
+    };
+}
@@ -7,6 +7,7 @@
 #include <GLES3/gl3platform.h>
 #include <EGL/egl.h>
 #include <EGL/eglext.h>
+#include "StateShadow.h"
 #include <gsl/gsl>
 
 namespace android::OpenGLHelpers
@@ -16,26 +17,30 @@ namespace android::OpenGLHelpers
         return texture - GL_TEXTURE0;
     }
 
-    GLuint CreateShaderProgram(const char* vertShaderSource, const char* fragShaderSource);
+    GLuint LoadShader(GLenum shaderType, const char* shaderSource);
+
+    // Links a program from compiled shaders, which are detached again but not deleted so they can be shared.
+    GLuint LinkShaderProgram(GLuint vertShader, GLuint fragShader, bool binaryRetrievable = false);
+
+    // Set binaryRetrievable when the program binary is going to be read back with glGetProgramBinary.
+    GLuint CreateShaderProgram(const char* vertShaderSource, const char* fragShaderSource, bool binaryRetrievable = false);
 
     namespace GLTransactions
     {
+        // The previous binding comes from the StateShadow, and eglMakeCurrent is skipped when the binding does not change.
         inline auto MakeCurrent(EGLDisplay display, EGLSurface drawSurface, EGLSurface readSurface, EGLContext context)
         {
-            EGLDisplay previousDisplay{ eglGetDisplay(EGL_DEFAULT_DISPLAY) };
-            EGLSurface previousDrawSurface{ eglGetCurrentSurface(EGL_DRAW) };
-            EGLSurface previousReadSurface{ eglGetCurrentSurface(EGL_READ) };
-            EGLContext previousContext{ eglGetCurrentContext() };
-            eglMakeCurrent(display, drawSurface, readSurface, context);
-            return gsl::finally([previousDisplay, previousDrawSurface, previousReadSurface, previousContext]() { eglMakeCurrent(previousDisplay, previousDrawSurface, previousReadSurface, previousContext); });
+            EGLBinding previousBinding{ StateShadow::GetEGLBinding() };
+            StateShadow::SetEGLBinding({ display, drawSurface, readSurface, context });
+            return gsl::finally([previousBinding]() { StateShadow::SetEGLBinding(previousBinding); });
         }
 
         inline auto SetStencil(uint8_t mask)
         {
-            GLint previousStencilMask{};
-            glGetIntegerv(GL_STENCIL_WRITEMASK, &previousStencilMask);
-            glStencilMask(mask);
-            return gsl::finally([previousStencilMask]() { glStencilMask(previousStencilMask); });
+            StateShadow& state{ StateShadow::Current() };
+            GLuint previousStencilMask{ state.GetStencilWriteMask() };
+            state.SetStencilWriteMask(mask);
+            return gsl::finally([&state, previousStencilMask]() { state.SetStencilWriteMask(previousStencilMask); });
         }
     }
 }
\ No newline at end of file
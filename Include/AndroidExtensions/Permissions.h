@@ -1,8 +1,18 @@
 #pragma once
 
 #include <arcana/threading/task.h>
+#include "JavaWrappers.h"
+#include <string>
+#include <vector>
 
 namespace android::Permissions
 {
     arcana::task<void, std::exception_ptr> CheckCameraPermissionAsync();
+
+    // Requests the given permissions (e.g. "android.permission.CAMERA") with a single system prompt. Permissions that
+    // are already granted are not requested again, and permissions that already have a request in flight join that
+    // request instead of prompting twice. The task fails if any of the permissions is denied.
+    arcana::task<void, std::exception_ptr> RequestPermissionsAsync(std::vector<std::string> permissions);
+
+    arcana::task<void, std::exception_ptr> RequestPermissionsAsync(const std::vector<ManifestPermission::Permission>& permissions);
 }
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "OpenGLHelpers.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace android::OpenGLHelpers
+{
+    // Persists linked shader programs with glGetProgramBinary so later launches can skip compilation. Entries are
+    // keyed by a hash of the shader sources, GL_RENDERER and GL_VERSION, so driver updates invalidate them. All
+    // methods other than GetStatistics must be called on a thread with a current OpenGL ES 3 context.
+    class ProgramBinaryCache final
+    {
+    public:
+        struct Statistics
+        {
+            size_t Hits;
+            size_t Misses;
+
+            // Binaries that were found on disk but that the driver refused to load.
+            size_t Rejected;
+        };
+
+        // The directory must exist and be writable, e.g. the path returned by Context.getCacheDir().
+        explicit ProgramBinaryCache(std::string directory);
+
+        ProgramBinaryCache(const ProgramBinaryCache&) = delete;
+        ProgramBinaryCache& operator=(const ProgramBinaryCache&) = delete;
+
+        // Loads the program from the cache if possible, otherwise compiles and links it and stores the result.
+        GLuint CreateShaderProgram(const char* vertShaderSource, const char* fragShaderSource);
+
+        uint64_t GetKey(const char* vertShaderSource, const char* fragShaderSource);
+
+        // Returns 0 if there is no usable binary for the key. A rejected binary is removed from the cache.
+        GLuint TryLoad(uint64_t key);
+
+        // Stores the binary of a linked program. Programs should be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+        // set. Failures to write are ignored, since the cache is only an optimization.
+        void Store(uint64_t key, GLuint program);
+
+        // Deletes every binary in the cache directory.
+        void Clear();
+
+        Statistics GetStatistics() const;
+
+    private:
+        std::string GetPath(uint64_t key) const;
+        void InitializeDriverInfo();
+
+        const std::string m_directory;
+
+        // Queried once from whichever context first uses the cache, which may be a shared-context worker.
+        std::once_flag m_driverInfoOnce{};
+        uint64_t m_driverHash{};
+        std::vector<GLint> m_binaryFormats{};
+        bool m_supported{};
+        std::atomic<size_t> m_hits{};
+        std::atomic<size_t> m_misses{};
+        std::atomic<size_t> m_rejected{};
+    };
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "MemoryPressure.h"
+#include "StateShadow.h"
+#include <memory>
+#include <string>
+
+namespace android::OpenGLHelpers
+{
+    struct TextureDescription
+    {
+        GLenum Target{GL_TEXTURE_2D};
+        GLenum InternalFormat{GL_RGBA8};
+        GLsizei Width{};
+        GLsizei Height{};
+        GLsizei Levels{1};
+    };
+
+    struct BufferDescription
+    {
+        GLsizeiptr Size{};
+        GLenum Usage{GL_STREAM_DRAW};
+    };
+
+    // A framebuffer with a single color texture and an optional depth/stencil renderbuffer.
+    struct RenderTargetDescription
+    {
+        GLsizei Width{};
+        GLsizei Height{};
+        GLenum ColorFormat{GL_RGBA8};
+        GLenum DepthStencilFormat{GL_NONE};
+    };
+
+    // Recycles textures, buffers and render targets so transient objects are not created and deleted on every use.
+    // Released objects are kept idle and handed out again for identical descriptions, least recently released ones
+    // are deleted first when trimming, and the pool registers with MemoryPressure. Acquire, Trim and
+    // ProcessPendingTrim, as well as releasing handles and destroying the pool, must happen on the thread with the
+    // OpenGL ES context current. The contents of recycled objects are undefined.
+    class ResourcePool final
+    {
+        struct State;
+        struct Resource;
+
+    public:
+        // Returns its object to the pool when destroyed, or deletes it if the pool no longer exists.
+        class Handle
+        {
+        public:
+            Handle();
+            ~Handle();
+
+            Handle(const Handle&) = delete;
+            Handle& operator=(const Handle&) = delete;
+
+            Handle(Handle&&) noexcept;
+            Handle& operator=(Handle&&) noexcept;
+
+            explicit operator bool() const;
+
+            void Release();
+
+        protected:
+            Handle(std::shared_ptr<State> state, std::unique_ptr<Resource> resource);
+
+            GLuint GetName(size_t index) const;
+
+        private:
+            std::shared_ptr<State> m_state{};
+            std::unique_ptr<Resource> m_resource{};
+
+            friend class ResourcePool;
+        };
+
+        class Texture final : public Handle
+        {
+        public:
+            GLuint Name() const;
+
+        private:
+            using Handle::Handle;
+
+            friend class ResourcePool;
+        };
+
+        class Buffer final : public Handle
+        {
+        public:
+            GLuint Name() const;
+
+        private:
+            using Handle::Handle;
+
+            friend class ResourcePool;
+        };
+
+        class RenderTarget final : public Handle
+        {
+        public:
+            GLuint Framebuffer() const;
+
+            GLuint ColorTexture() const;
+
+        private:
+            using Handle::Handle;
+
+            friend class ResourcePool;
+        };
+
+        struct Statistics
+        {
+            size_t Created;
+            size_t Reused;
+            size_t Deleted;
+            size_t InUse;
+            size_t Idle;
+            size_t InUseBytes;
+            size_t IdleBytes;
+        };
+
+        // Trimming for memory pressure is requested from whatever thread reports it, and carried out by the next
+        // ProcessPendingTrim call. Since no frames are rendered while the app is in the background, trimDispatcher
+        // can schedule that call right away; it must run the work on the thread with the OpenGL ES context current.
+        explicit ResourcePool(std::string name = "ResourcePool", int32_t trimPriority = 0, global::CallbackDispatcher trimDispatcher = {});
+        ~ResourcePool();
+
+        ResourcePool(const ResourcePool&) = delete;
+        ResourcePool& operator=(const ResourcePool&) = delete;
+
+        Texture AcquireTexture(const TextureDescription& description);
+
+        // Buffers are allocated through GL_COPY_WRITE_BUFFER and can then be bound to any target.
+        Buffer AcquireBuffer(const BufferDescription& description);
+
+        RenderTarget AcquireRenderTarget(const RenderTargetDescription& description);
+
+        // Deletes idle objects until at least the given number of bytes has been released, and returns the number
+        // of bytes released. Objects in use are not affected.
+        size_t Trim(size_t bytesToRelease);
+
+        // Carries out trimming requested through MemoryPressure. Call regularly, e.g. once per frame.
+        void ProcessPendingTrim();
+
+        Statistics GetStatistics() const;
+
+    private:
+        std::unique_ptr<Resource> Acquire(const Resource& key);
+
+        std::shared_ptr<State> m_state;
+        MemoryPressure::CacheTicket m_cacheTicket;
+    };
+}
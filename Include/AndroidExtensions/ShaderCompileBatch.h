@@ -0,0 +1,58 @@
+#pragma once
+
+#include "OpenGLHelpers.h"
+#include <arcana/threading/task.h>
+#include <vector>
+
+namespace android::OpenGLHelpers
+{
+    class ProgramBinaryCache;
+
+    // Compiles and links many programs without waiting on each one. Status queries force the driver to finish the
+    // compile, so they are deferred until Poll or Finish, and with GL_KHR_parallel_shader_compile the driver compiles
+    // on its own threads while Poll checks for completion without blocking. All methods must be called on the thread
+    // with the OpenGL ES context current, and the returned tasks complete on that thread.
+    class ShaderCompileBatch final
+    {
+    public:
+        // Programs found in the optional cache complete right away, and newly linked ones are stored in it.
+        explicit ShaderCompileBatch(ProgramBinaryCache* cache = nullptr);
+        ~ShaderCompileBatch();
+
+        ShaderCompileBatch(const ShaderCompileBatch&) = delete;
+        ShaderCompileBatch& operator=(const ShaderCompileBatch&) = delete;
+
+        // Submits the sources for compilation and linking. The task fails with the compile or link log if the program
+        // is invalid.
+        arcana::task<GLuint, std::exception_ptr> Add(const char* vertShaderSource, const char* fragShaderSource);
+
+        // Completes the tasks of every program the driver has finished with. Without GL_KHR_parallel_shader_compile,
+        // completion cannot be queried without blocking, so this completes everything like Finish. Returns the number
+        // of programs still pending.
+        size_t Poll();
+
+        // Blocks until every submitted program is compiled and linked and completes their tasks.
+        void Finish();
+
+        size_t Pending() const;
+
+        // Whether the driver supports GL_KHR_parallel_shader_compile.
+        bool IsParallel() const;
+
+    private:
+        struct PendingProgram
+        {
+            GLuint VertShader;
+            GLuint FragShader;
+            GLuint Program;
+            uint64_t CacheKey;
+            arcana::task_completion_source<GLuint, std::exception_ptr> Tcs;
+        };
+
+        void Complete(PendingProgram& pending);
+
+        ProgramBinaryCache* m_cache{};
+        bool m_parallel{};
+        std::vector<PendingProgram> m_pending{};
+    };
+}
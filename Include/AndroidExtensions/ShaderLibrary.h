@@ -0,0 +1,69 @@
+#pragma once
+
+#include "OpenGLHelpers.h"
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace android::OpenGLHelpers
+{
+    class ProgramBinaryCache;
+
+    // Builds shader variants from a source and a set of preprocessor defines. Identical final sources share one shader
+    // object across all programs that use them, and each distinct pair of sources is only linked once. Programs and
+    // shaders are owned by the library, so all methods including the destructor must be called on the thread with the
+    // OpenGL ES context current.
+    class ShaderLibrary final
+    {
+    public:
+        // Ordered, so the same set of defines always produces the same source. An empty value emits a bare #define.
+        using Defines = std::map<std::string, std::string>;
+
+        struct Statistics
+        {
+            size_t Shaders;
+            size_t Programs;
+            size_t ShaderHits;
+            size_t ProgramHits;
+        };
+
+        // Linked programs are stored in the optional cache, and programs found in it skip compilation.
+        explicit ShaderLibrary(ProgramBinaryCache* cache = nullptr);
+        ~ShaderLibrary();
+
+        ShaderLibrary(const ShaderLibrary&) = delete;
+        ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+        // Inserts the defines after the #version directive, which has to stay the first line of the shader.
+        static std::string Preprocess(std::string_view source, const Defines& defines);
+
+        // Returns a program that stays valid until Clear is called or the library is destroyed.
+        GLuint GetProgram(std::string_view vertShaderSource, std::string_view fragShaderSource, const Defines& defines = {});
+
+        GLuint GetProgram(std::string_view vertShaderSource, const Defines& vertDefines, std::string_view fragShaderSource, const Defines& fragDefines);
+
+        // Deletes every shader and program created by the library.
+        void Clear();
+
+        Statistics GetStatistics() const;
+
+    private:
+        using SourceMap = std::unordered_map<std::string, GLuint>;
+
+        GLuint GetShader(SourceMap::value_type& entry, GLenum shaderType);
+
+        ProgramBinaryCache* m_cache{};
+
+        // Final sources mapped to their shader objects, which are only compiled once a program needs linking. Vertex
+        // and fragment sources are kept apart since the same text could in theory be valid for both stages.
+        SourceMap m_vertShaders{};
+        SourceMap m_fragShaders{};
+
+        // Keyed by the addresses of the map entries above, which stay stable until Clear.
+        std::map<std::pair<const std::string*, const std::string*>, GLuint> m_programs{};
+
+        size_t m_shaderHits{};
+        size_t m_programHits{};
+    };
+}
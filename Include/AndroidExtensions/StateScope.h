@@ -0,0 +1,71 @@
+#pragma once
+
+#include "StateShadow.h"
+#include <functional>
+#include <vector>
+
+namespace android::OpenGLHelpers::GLTransactions
+{
+    // Changes any combination of render state for the lifetime of the scope, and restores on destruction only the
+    // values that actually changed, in reverse order. Previous values come from the StateShadow, so nested scopes
+    // do not query GL. Setting the same state twice in one scope still restores the value from before the scope.
+    class StateScope final
+    {
+    public:
+        // Uses the shadow of the context current on the calling thread, which must stay current for the whole scope.
+        StateScope();
+        ~StateScope();
+
+        StateScope(const StateScope&) = delete;
+        StateScope& operator=(const StateScope&) = delete;
+
+        StateScope& SetEnabled(GLenum capability, bool enabled);
+        StateScope& SetStencilWriteMask(GLuint mask);
+        StateScope& SetBlendFunc(const BlendFunc& blendFunc);
+        StateScope& SetDepthWriteMask(bool enabled);
+        StateScope& SetDepthFunc(GLenum func);
+        StateScope& SetViewport(const Rect& viewport);
+        StateScope& SetScissor(const Rect& scissor);
+        StateScope& UseProgram(GLuint program);
+        StateScope& SetActiveTexture(GLenum unit);
+
+        // Binds the texture on the given unit, leaving the active texture unit as it was.
+        StateScope& BindTexture(GLenum unit, GLenum target, GLuint texture);
+
+        StateScope& BindBuffer(GLenum target, GLuint buffer);
+        StateScope& BindVertexArray(GLuint vertexArray);
+        StateScope& BindFramebuffer(GLenum target, GLuint framebuffer);
+
+    private:
+        // Identifies a piece of state together with its target, so it is only saved once per scope.
+        enum class StateType : uint8_t
+        {
+            Capability,
+            StencilWriteMask,
+            BlendFunc,
+            DepthWriteMask,
+            DepthFunc,
+            Viewport,
+            Scissor,
+            Program,
+            ActiveTexture,
+            Texture,
+            Buffer,
+            VertexArray,
+            DrawFramebuffer,
+            ReadFramebuffer,
+        };
+
+        void Save(StateType type, uint64_t target, std::function<void(StateShadow&)>&& restore);
+
+        struct SavedState
+        {
+            StateType Type;
+            uint64_t Target;
+            std::function<void(StateShadow&)> Restore;
+        };
+
+        StateShadow& m_state;
+        std::vector<SavedState> m_saved{};
+    };
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include <GLES3/gl3.h>
+#include <EGL/egl.h>
+#include <optional>
+#include <unordered_map>
+
+namespace android::OpenGLHelpers
+{
+    struct EGLBinding
+    {
+        EGLDisplay Display;
+        EGLSurface DrawSurface;
+        EGLSurface ReadSurface;
+        EGLContext Context;
+
+        bool operator==(const EGLBinding& other) const
+        {
+            return Display == other.Display && DrawSurface == other.DrawSurface && ReadSurface == other.ReadSurface && Context == other.Context;
+        }
+
+        bool operator!=(const EGLBinding& other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    struct Rect
+    {
+        GLint X;
+        GLint Y;
+        GLsizei Width;
+        GLsizei Height;
+
+        bool operator==(const Rect& other) const
+        {
+            return X == other.X && Y == other.Y && Width == other.Width && Height == other.Height;
+        }
+
+        bool operator!=(const Rect& other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    struct BlendFunc
+    {
+        GLenum SrcRGB;
+        GLenum DstRGB;
+        GLenum SrcAlpha;
+        GLenum DstAlpha;
+
+        bool operator==(const BlendFunc& other) const
+        {
+            return SrcRGB == other.SrcRGB && DstRGB == other.DstRGB && SrcAlpha == other.SrcAlpha && DstAlpha == other.DstAlpha;
+        }
+
+        bool operator!=(const BlendFunc& other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    // Mirrors frequently changed OpenGL ES state of one context, so that state can be read without a glGet, which
+    // may stall the pipeline, and redundant changes can be skipped. Each value is queried from GL the first time it is
+    // read and tracked from then on. Code that changes state behind the shadow's back, such as third party renderers,
+    // must call Invalidate afterwards, and deleted objects must be reported so their names are not mistaken for
+    // bindings of new objects that reuse them.
+    class StateShadow final
+    {
+    public:
+        // Returns the shadow of the context current on the calling thread. Throws if no context is current.
+        static StateShadow& Current();
+
+        // Releases the shadow of a context. Call before destroying the context.
+        static void ContextDestroyed(EGLContext context);
+
+        // The EGL binding of the calling thread, tracked by SetEGLBinding and queried again whenever the current
+        // context no longer matches it.
+        static EGLBinding GetEGLBinding();
+
+        // Makes the binding current unless it already is. Returns false if eglMakeCurrent fails.
+        static bool SetEGLBinding(const EGLBinding& binding);
+
+        // Forgets the tracked EGL binding of the calling thread. Only needed after eglMakeCurrent was called directly
+        // to change the surfaces while keeping the same context current.
+        static void InvalidateEGLBinding();
+
+        StateShadow() = default;
+
+        StateShadow(const StateShadow&) = delete;
+        StateShadow& operator=(const StateShadow&) = delete;
+
+        // Forgets all tracked state, so every value is queried again the next time it is read.
+        void Invalidate();
+
+        // Supports GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST, GL_SCISSOR_TEST and GL_STENCIL_TEST.
+        bool IsEnabled(GLenum capability);
+        void SetEnabled(GLenum capability, bool enabled);
+
+        GLuint GetStencilWriteMask();
+        void SetStencilWriteMask(GLuint mask);
+
+        BlendFunc GetBlendFunc();
+        void SetBlendFunc(const BlendFunc& blendFunc);
+
+        bool GetDepthWriteMask();
+        void SetDepthWriteMask(bool enabled);
+
+        GLenum GetDepthFunc();
+        void SetDepthFunc(GLenum func);
+
+        Rect GetViewport();
+        void SetViewport(const Rect& viewport);
+
+        Rect GetScissor();
+        void SetScissor(const Rect& scissor);
+
+        GLuint GetProgram();
+        void UseProgram(GLuint program);
+
+        GLenum GetActiveTexture();
+        void SetActiveTexture(GLenum unit);
+
+        // Supports GL_TEXTURE_2D, GL_TEXTURE_3D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_CUBE_MAP and GL_TEXTURE_EXTERNAL_OES,
+        // on the active texture unit.
+        GLuint GetTexture(GLenum target);
+        void BindTexture(GLenum target, GLuint texture);
+
+        // Supports the generic binding points other than GL_ELEMENT_ARRAY_BUFFER, which is vertex array state.
+        GLuint GetBuffer(GLenum target);
+        void BindBuffer(GLenum target, GLuint buffer);
+
+        GLuint GetVertexArray();
+        void BindVertexArray(GLuint vertexArray);
+
+        // GL_FRAMEBUFFER reads the draw binding and binds both.
+        GLuint GetFramebuffer(GLenum target);
+        void BindFramebuffer(GLenum target, GLuint framebuffer);
+
+        // Deletes the objects and clears any tracked bindings of them, as GL does.
+        void DeleteTextures(GLsizei count, const GLuint* textures);
+        void DeleteBuffers(GLsizei count, const GLuint* buffers);
+        void DeleteFramebuffers(GLsizei count, const GLuint* framebuffers);
+        void DeleteVertexArrays(GLsizei count, const GLuint* vertexArrays);
+
+    private:
+        std::unordered_map<GLenum, bool> m_capabilities{};
+        std::optional<GLuint> m_stencilWriteMask{};
+        std::optional<BlendFunc> m_blendFunc{};
+        std::optional<bool> m_depthWriteMask{};
+        std::optional<GLenum> m_depthFunc{};
+        std::optional<Rect> m_viewport{};
+        std::optional<Rect> m_scissor{};
+        std::optional<GLuint> m_program{};
+        std::optional<GLenum> m_activeTexture{};
+
+        // Keyed by the texture unit in the upper and the target in the lower half.
+        std::unordered_map<uint64_t, GLuint> m_textures{};
+        std::unordered_map<GLenum, GLuint> m_buffers{};
+        std::optional<GLuint> m_vertexArray{};
+        std::optional<GLuint> m_drawFramebuffer{};
+        std::optional<GLuint> m_readFramebuffer{};
+    };
+}
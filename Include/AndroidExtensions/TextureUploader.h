@@ -0,0 +1,71 @@
+#pragma once
+
+#include "GLWorkerPool.h"
+#include <arcana/threading/task.h>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace android::OpenGLHelpers
+{
+    // Streams pixel data into textures over several frames. Pixels are staged into a ring of reused pixel unpack
+    // buffers and uploaded with glTexSubImage2D, at most bytesPerFrame per ProcessFrame call, so large textures do not
+    // stall a single frame. All methods must be called on the thread with the OpenGL ES context current, and tasks
+    // complete on that thread once the GPU has consumed the last staged rows.
+    class TextureUploader final
+    {
+    public:
+        struct Statistics
+        {
+            size_t PendingUploads;
+            uint64_t CompletedUploads;
+            uint64_t BytesUploaded;
+        };
+
+        // Rows larger than stagingBufferSize cannot be uploaded.
+        TextureUploader(size_t bytesPerFrame, size_t stagingBufferSize = 4 * 1024 * 1024, size_t stagingBufferCount = 3);
+
+        // Pending uploads fail with an error.
+        ~TextureUploader();
+
+        TextureUploader(const TextureUploader&) = delete;
+        TextureUploader& operator=(const TextureUploader&) = delete;
+
+        // Queues an upload of tightly packed rows into a region of an existing 2D texture, which should have immutable
+        // storage so it cannot be reallocated while the upload is in flight.
+        arcana::task<void, std::exception_ptr> UploadAsync(GLuint texture, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+            GLenum format, GLenum type, std::vector<std::byte> pixels);
+
+        // Completes uploads the GPU has finished with, then stages and issues rows until the frame budget is spent or
+        // every staging buffer is in flight. Call once per frame.
+        void ProcessFrame();
+
+        Statistics GetStatistics() const;
+
+    private:
+        struct Upload;
+
+        struct StagingBuffer
+        {
+            GLuint Buffer{};
+            OpenGLHelpers::Fence Fence{};
+
+            // Uploads whose last rows were staged in this buffer, which are done once its fence is signaled.
+            std::vector<std::unique_ptr<Upload>> Completing{};
+        };
+
+        void CompleteSignaledBuffers();
+
+        const size_t m_bytesPerFrame;
+        const size_t m_stagingBufferSize;
+        std::vector<StagingBuffer> m_stagingBuffers{};
+        size_t m_nextStagingBuffer{};
+
+        // Uploads that still have rows left to stage, in submission order.
+        std::deque<std::unique_ptr<Upload>> m_queue{};
+
+        uint64_t m_completedUploads{};
+        uint64_t m_bytesUploaded{};
+    };
+}
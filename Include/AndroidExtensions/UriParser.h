@@ -0,0 +1,67 @@
+#pragma once
+
+#include "JavaWrappers.h"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace android::net
+{
+    // Components of a URI reference as split by RFC 3986. Each view points into the parsed string and is empty when
+    // the component is absent. Components are not percent decoded.
+    struct UriComponents
+    {
+        std::string_view Scheme;
+        std::string_view Authority;
+        std::string_view UserInfo;
+        std::string_view Host; // IPv6 literals keep their brackets, as with java.net.URI.getHost.
+        int32_t Port{-1};
+        std::string_view Path; // For opaque URIs such as mailto:, the whole scheme specific part.
+        std::string_view Query;
+        std::string_view Fragment;
+        bool Opaque{};
+    };
+
+    // Splits a URI without calling into Java. Returns nothing for strings that java.net.URI would reject with a
+    // URISyntaxException, such as ones containing spaces, malformed percent escapes or a non numeric port.
+    std::optional<UriComponents> ParseUri(std::string_view uri);
+
+    // Replaces percent escapes with the bytes they encode, as android.net.Uri does for its decoded getters.
+    std::string DecodeUriComponent(std::string_view component);
+
+    // A parsed URI that owns its string. The Java Uri and URL equivalents are only created the first time a
+    // Java API needs them, and are then shared by all copies.
+    class ParsedUri final
+    {
+    public:
+        // Throws std::runtime_error for strings that ParseUri rejects.
+        explicit ParsedUri(std::string uri);
+
+        const std::string& ToString() const;
+
+        std::string_view Scheme() const;
+        std::string_view Authority() const;
+        std::string_view UserInfo() const;
+        std::string_view Host() const;
+        int32_t Port() const;
+        std::string_view Path() const;
+        std::string_view Query() const;
+        std::string_view Fragment() const;
+
+        bool IsAbsolute() const;
+        bool IsOpaque() const;
+
+        std::string DecodedPath() const;
+
+        Uri ToUri() const;
+
+        java::net::URL ToURL() const;
+
+    private:
+        struct State;
+
+        std::shared_ptr<State> m_state;
+    };
+}
@@ -0,0 +1,62 @@
+#include <AndroidExtensions/AssetArchive.h>
+#include <stdexcept>
+#include <string>
+
+namespace android::Assets
+{
+    AssetArchive::AssetArchive(AAssetManager* assetManager, const char* path)
+        : m_asset{assetManager, path, AccessMode::Random}
+        , m_reader{m_asset.Data().data(), m_asset.Data().size()}
+    {
+    }
+
+    bool AssetArchive::Contains(std::string_view path) const
+    {
+        return m_reader.Find(path).has_value();
+    }
+
+    std::optional<Archive::Entry> AssetArchive::Find(std::string_view path) const
+    {
+        return m_reader.Find(path);
+    }
+
+    gsl::span<const std::byte> AssetArchive::GetData(std::string_view path) const
+    {
+        const auto entry{GetRequiredEntry(path)};
+        if (entry.Compression != Archive::Compression::None)
+        {
+            throw std::runtime_error{"Asset archive entry " + std::string{path} + " is compressed"};
+        }
+
+        return {entry.Data, static_cast<size_t>(entry.Size)};
+    }
+
+    std::vector<std::byte> AssetArchive::Read(std::string_view path) const
+    {
+        const auto entry{GetRequiredEntry(path)};
+        std::vector<std::byte> data(static_cast<size_t>(entry.Size));
+        Archive::Reader::Extract(entry, data.data());
+        return data;
+    }
+
+    size_t AssetArchive::EntryCount() const
+    {
+        return m_reader.EntryCount();
+    }
+
+    Archive::Entry AssetArchive::GetEntry(size_t index) const
+    {
+        return m_reader.GetEntry(index);
+    }
+
+    Archive::Entry AssetArchive::GetRequiredEntry(std::string_view path) const
+    {
+        auto entry{m_reader.Find(path)};
+        if (!entry)
+        {
+            throw std::runtime_error{"Asset archive does not contain " + std::string{path}};
+        }
+
+        return *entry;
+    }
+}
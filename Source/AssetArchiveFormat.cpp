@@ -0,0 +1,375 @@
+#include <AndroidExtensions/AssetArchiveFormat.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace android::Assets::Archive
+{
+    namespace
+    {
+        // Parameters of the LZ4 block format.
+        constexpr size_t MIN_MATCH{4};
+        constexpr size_t LAST_LITERALS{5};
+        constexpr size_t MATCH_FIND_LIMIT{12};
+        constexpr size_t MAX_OFFSET{65535};
+        constexpr size_t HASH_BITS{16};
+
+        // Each byte of an LZ4 block decodes to at most 255 bytes, which bounds the size a valid entry can declare.
+        constexpr uint64_t MAX_EXPANSION{255};
+
+        uint32_t ReadUInt32(const std::byte* data)
+        {
+            uint32_t value{};
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        uint32_t Hash(uint32_t sequence)
+        {
+            return (sequence * 2654435761u) >> (32 - HASH_BITS);
+        }
+
+        void WriteLength(std::vector<std::byte>& output, size_t length)
+        {
+            while (length >= 255)
+            {
+                output.push_back(std::byte{255});
+                length -= 255;
+            }
+
+            output.push_back(static_cast<std::byte>(length));
+        }
+
+        void WriteSequence(std::vector<std::byte>& output, const std::byte* literals, size_t literalLength, size_t offset, size_t matchLength)
+        {
+            const size_t encodedMatchLength{matchLength == 0 ? 0 : matchLength - MIN_MATCH};
+            output.push_back(static_cast<std::byte>((std::min<size_t>(literalLength, 15) << 4) | std::min<size_t>(encodedMatchLength, 15)));
+            if (literalLength >= 15)
+            {
+                WriteLength(output, literalLength - 15);
+            }
+
+            output.insert(output.end(), literals, literals + literalLength);
+
+            if (matchLength != 0)
+            {
+                output.push_back(static_cast<std::byte>(offset & 0xFF));
+                output.push_back(static_cast<std::byte>(offset >> 8));
+                if (encodedMatchLength >= 15)
+                {
+                    WriteLength(output, encodedMatchLength - 15);
+                }
+            }
+        }
+
+        bool ReadLength(const std::byte*& input, const std::byte* inputEnd, size_t& length)
+        {
+            uint8_t value{};
+            do
+            {
+                if (input == inputEnd)
+                {
+                    return false;
+                }
+
+                value = static_cast<uint8_t>(*input++);
+                length += value;
+            } while (value == 255);
+
+            return true;
+        }
+
+        bool InRange(uint64_t offset, uint64_t length, size_t size)
+        {
+            return offset <= size && length <= size - offset;
+        }
+    }
+
+    uint32_t Crc32(const std::byte* data, size_t size)
+    {
+        static const auto table{[]()
+        {
+            std::array<uint32_t, 256> table{};
+            for (uint32_t index = 0; index < table.size(); ++index)
+            {
+                uint32_t value{index};
+                for (int bit = 0; bit < 8; ++bit)
+                {
+                    value = (value & 1) ? (value >> 1) ^ 0xEDB88320u : value >> 1;
+                }
+                table[index] = value;
+            }
+            return table;
+        }()};
+
+        uint32_t crc{0xFFFFFFFFu};
+        for (size_t index = 0; index < size; ++index)
+        {
+            crc = table[(crc ^ static_cast<uint8_t>(data[index])) & 0xFF] ^ (crc >> 8);
+        }
+
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    std::vector<std::byte> CompressLZ4(const std::byte* source, size_t sourceSize)
+    {
+        std::vector<std::byte> output{};
+        output.reserve(sourceSize);
+
+        size_t anchor{};
+        if (sourceSize > MATCH_FIND_LIMIT)
+        {
+            // Greedy parse using the most recent position of each hashed four byte sequence.
+            std::vector<int64_t> table(size_t{1} << HASH_BITS, -1);
+            const size_t matchStartLimit{sourceSize - MATCH_FIND_LIMIT};
+            const size_t matchEndLimit{sourceSize - LAST_LITERALS};
+
+            size_t position{};
+            while (position < matchStartLimit)
+            {
+                const uint32_t sequence{ReadUInt32(source + position)};
+                const uint32_t hash{Hash(sequence)};
+                const int64_t candidate{table[hash]};
+                table[hash] = static_cast<int64_t>(position);
+
+                if (candidate < 0 || position - static_cast<size_t>(candidate) > MAX_OFFSET || ReadUInt32(source + candidate) != sequence)
+                {
+                    ++position;
+                    continue;
+                }
+
+                size_t matchLength{MIN_MATCH};
+                while (position + matchLength < matchEndLimit && source[candidate + matchLength] == source[position + matchLength])
+                {
+                    ++matchLength;
+                }
+
+                WriteSequence(output, source + anchor, position - anchor, position - static_cast<size_t>(candidate), matchLength);
+                position += matchLength;
+                anchor = position;
+
+                if (output.size() >= sourceSize)
+                {
+                    return {};
+                }
+            }
+        }
+
+        // The block always ends with a sequence made only of literals.
+        WriteSequence(output, source + anchor, sourceSize - anchor, 0, 0);
+        if (output.size() >= sourceSize)
+        {
+            return {};
+        }
+
+        return output;
+    }
+
+    bool DecompressLZ4(const std::byte* source, size_t sourceSize, std::byte* destination, size_t destinationSize)
+    {
+        const std::byte* input{source};
+        const std::byte* const inputEnd{source + sourceSize};
+        std::byte* output{destination};
+        std::byte* const outputEnd{destination + destinationSize};
+
+        while (input < inputEnd)
+        {
+            const auto token{static_cast<uint8_t>(*input++)};
+
+            size_t literalLength{static_cast<size_t>(token >> 4)};
+            if (literalLength == 15 && !ReadLength(input, inputEnd, literalLength))
+            {
+                return false;
+            }
+
+            if (literalLength > static_cast<size_t>(inputEnd - input) || literalLength > static_cast<size_t>(outputEnd - output))
+            {
+                return false;
+            }
+
+            // Sequences that are only a match carry no literals, and the output may still be null when it is empty.
+            if (literalLength != 0)
+            {
+                std::memcpy(output, input, literalLength);
+                input += literalLength;
+                output += literalLength;
+            }
+
+            if (input == inputEnd)
+            {
+                break;
+            }
+
+            if (inputEnd - input < 2)
+            {
+                return false;
+            }
+
+            const size_t offset{static_cast<size_t>(input[0]) | (static_cast<size_t>(input[1]) << 8)};
+            input += 2;
+            if (offset == 0 || offset > static_cast<size_t>(output - destination))
+            {
+                return false;
+            }
+
+            size_t matchLength{static_cast<size_t>(token & 15)};
+            if (matchLength == 15 && !ReadLength(input, inputEnd, matchLength))
+            {
+                return false;
+            }
+
+            matchLength += MIN_MATCH;
+            if (matchLength > static_cast<size_t>(outputEnd - output))
+            {
+                return false;
+            }
+
+            // Matches may overlap the bytes they produce, so they are copied one byte at a time.
+            const std::byte* match{output - offset};
+            for (size_t index = 0; index < matchLength; ++index)
+            {
+                output[index] = match[index];
+            }
+
+            output += matchLength;
+        }
+
+        return output == outputEnd;
+    }
+
+    Reader::Reader(const std::byte* data, size_t size)
+        : m_data{data}
+        , m_size{size}
+    {
+        Header header{};
+        if (size < sizeof(header))
+        {
+            throw std::runtime_error{"Asset archive is truncated"};
+        }
+
+        std::memcpy(&header, data, sizeof(header));
+        if (header.Magic != MAGIC || header.Version != VERSION)
+        {
+            throw std::runtime_error{"Unsupported asset archive format"};
+        }
+
+        if (!InRange(header.EntryTableOffset, uint64_t{header.EntryCount} * sizeof(EntryRecord), size) ||
+            header.PathTableOffset > size)
+        {
+            throw std::runtime_error{"Asset archive header is corrupt"};
+        }
+
+        m_records = data + header.EntryTableOffset;
+        m_entryCount = header.EntryCount;
+        m_paths = reinterpret_cast<const char*>(data + header.PathTableOffset);
+
+        const size_t pathTableSize{size - static_cast<size_t>(header.PathTableOffset)};
+        for (uint32_t index = 0; index < m_entryCount; ++index)
+        {
+            const EntryRecord record{GetRecord(index)};
+            if (!InRange(record.PathOffset, record.PathLength, pathTableSize) ||
+                !InRange(record.DataOffset, record.StoredSize, size) ||
+                (record.Compression == Compression::None && record.StoredSize != record.Size) ||
+                (record.Compression == Compression::LZ4 && record.Size > record.StoredSize * MAX_EXPANSION) ||
+                (record.Compression != Compression::None && record.Compression != Compression::LZ4))
+            {
+                throw std::runtime_error{"Asset archive entry " + std::to_string(index) + " is corrupt"};
+            }
+        }
+    }
+
+    size_t Reader::EntryCount() const
+    {
+        return m_entryCount;
+    }
+
+    Entry Reader::GetEntry(size_t index) const
+    {
+        const EntryRecord record{GetRecord(index)};
+        return {
+            {m_paths + record.PathOffset, record.PathLength},
+            m_data + record.DataOffset,
+            record.StoredSize,
+            record.Size,
+            record.Compression,
+            record.Checksum,
+        };
+    }
+
+    std::optional<Entry> Reader::Find(std::string_view path) const
+    {
+        size_t first{};
+        size_t count{m_entryCount};
+        while (count > 0)
+        {
+            const size_t step{count / 2};
+            const EntryRecord record{GetRecord(first + step)};
+            if (std::string_view{m_paths + record.PathOffset, record.PathLength} < path)
+            {
+                first += step + 1;
+                count -= step + 1;
+            }
+            else
+            {
+                count = step;
+            }
+        }
+
+        if (first == m_entryCount)
+        {
+            return {};
+        }
+
+        Entry entry{GetEntry(first)};
+        if (entry.Path != path)
+        {
+            return {};
+        }
+
+        return entry;
+    }
+
+    EntryRecord Reader::GetRecord(size_t index) const
+    {
+        EntryRecord record{};
+        std::memcpy(&record, m_records + index * sizeof(EntryRecord), sizeof(record));
+        return record;
+    }
+
+    void Reader::Extract(const Entry& entry, std::byte* destination)
+    {
+        // Empty entries may come with a null destination, which must not be passed to memcpy.
+        if (entry.Size != 0)
+        {
+            if (entry.Compression == Compression::LZ4)
+            {
+                if (!DecompressLZ4(entry.Data, entry.StoredSize, destination, entry.Size))
+                {
+                    throw std::runtime_error{"Asset archive entry " + std::string{entry.Path} + " failed to decompress"};
+                }
+            }
+            else
+            {
+                std::memcpy(destination, entry.Data, entry.Size);
+            }
+        }
+
+        if (Crc32(destination, entry.Size) != entry.Checksum)
+        {
+            throw std::runtime_error{"Asset archive entry " + std::string{entry.Path} + " failed checksum verification"};
+        }
+    }
+
+    bool Reader::VerifyChecksum(const Entry& entry)
+    {
+        if (entry.Compression == Compression::None || entry.Size == 0)
+        {
+            return Crc32(entry.Data, entry.Size) == entry.Checksum;
+        }
+
+        std::vector<std::byte> data(entry.Size);
+        return DecompressLZ4(entry.Data, entry.StoredSize, data.data(), data.size()) && Crc32(data.data(), data.size()) == entry.Checksum;
+    }
+}
@@ -0,0 +1,236 @@
+#include <AndroidExtensions/AssetCache.h>
+#include <AndroidExtensions/Globals.h>
+#include <android/asset_manager_jni.h>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace android::Assets
+{
+    struct AssetCache::State final
+    {
+        using LoadCallback = std::function<void(const AssetPtr&, const std::exception_ptr&)>;
+
+        State(jobject assetManager, JavaThreadPool& threadPool, size_t capacity)
+            : AssetManagerRef{global::GetEnvForCurrentThread()->NewGlobalRef(assetManager)}
+            , NativeAssetManager{AAssetManager_fromJava(global::GetEnvForCurrentThread(), AssetManagerRef)}
+            , ThreadPool{threadPool}
+            , Capacity{capacity}
+        {
+        }
+
+        ~State()
+        {
+            global::GetEnvForCurrentThread()->DeleteGlobalRef(AssetManagerRef);
+        }
+
+        // Must be called with Mutex held.
+        void Touch(std::list<std::pair<std::string, AssetPtr>>::iterator entry)
+        {
+            Lru.splice(Lru.begin(), Lru, entry);
+        }
+
+        // Must be called with Mutex held.
+        size_t Evict(size_t bytesToRelease)
+        {
+            size_t released{};
+            while (released < bytesToRelease && !Lru.empty())
+            {
+                auto& [path, asset]{Lru.back()};
+                released += asset->Size();
+                Size -= asset->Size();
+                Entries.erase(path);
+                Lru.pop_back();
+            }
+
+            return released;
+        }
+
+        void Load(const std::string& path, LoadCallback&& callback, const std::shared_ptr<State>& self)
+        {
+            {
+                std::unique_lock<std::mutex> lock{Mutex};
+
+                auto entry{Entries.find(path)};
+                if (entry != Entries.end())
+                {
+                    Touch(entry->second);
+                    auto asset{entry->second->second};
+                    lock.unlock();
+                    callback(asset, {});
+                    return;
+                }
+
+                auto& waiters{Pending[path]};
+                waiters.push_back(std::move(callback));
+                if (waiters.size() > 1)
+                {
+                    // Another caller already started reading this asset.
+                    return;
+                }
+            }
+
+            ThreadPool([self, path]() {
+                AssetPtr asset{};
+                std::exception_ptr error{};
+                try
+                {
+                    auto loaded{std::make_shared<Asset>(self->NativeAssetManager, path.c_str(), AccessMode::Random)};
+                    loaded->Prefetch();
+                    asset = std::move(loaded);
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+
+                std::vector<LoadCallback> waiters{};
+                {
+                    std::lock_guard<std::mutex> guard{self->Mutex};
+                    if (asset)
+                    {
+                        self->Lru.emplace_front(path, asset);
+                        self->Entries[path] = self->Lru.begin();
+                        self->Size += asset->Size();
+                        if (self->Size > self->Capacity)
+                        {
+                            self->Evict(self->Size - self->Capacity);
+                        }
+                    }
+
+                    auto pending{self->Pending.find(path)};
+                    waiters = std::move(pending->second);
+                    self->Pending.erase(pending);
+                }
+
+                for (const auto& waiter : waiters)
+                {
+                    waiter(asset, error);
+                }
+            });
+        }
+
+        const jobject AssetManagerRef;
+        AAssetManager* const NativeAssetManager;
+        JavaThreadPool& ThreadPool;
+        const size_t Capacity;
+
+        mutable std::mutex Mutex{};
+        std::list<std::pair<std::string, AssetPtr>> Lru{};
+        std::unordered_map<std::string, std::list<std::pair<std::string, AssetPtr>>::iterator> Entries{};
+        std::unordered_map<std::string, std::vector<LoadCallback>> Pending{};
+        size_t Size{};
+    };
+
+    AssetCache::AssetCache(const content::res::AssetManager& assetManager, JavaThreadPool& threadPool, size_t capacity, int32_t trimPriority)
+        : m_state{std::make_shared<State>(assetManager, threadPool, capacity)}
+        , m_cacheTicket{MemoryPressure::RegisterCache("AssetCache", trimPriority,
+            [state{m_state}]() {
+                std::lock_guard<std::mutex> guard{state->Mutex};
+                return state->Size;
+            },
+            [state{m_state}](size_t bytesToRelease) {
+                std::lock_guard<std::mutex> guard{state->Mutex};
+                return state->Evict(bytesToRelease);
+            })}
+    {
+    }
+
+    AssetCache::~AssetCache() = default;
+
+    arcana::task<AssetCache::AssetPtr, std::exception_ptr> AssetCache::LoadAsync(const std::string& path)
+    {
+        arcana::task_completion_source<AssetPtr, std::exception_ptr> tcs{};
+        m_state->Load(path, [tcs](const AssetPtr& asset, const std::exception_ptr& error) mutable {
+            if (error)
+            {
+                tcs.complete(arcana::make_unexpected(error));
+            }
+            else
+            {
+                tcs.complete(asset);
+            }
+        }, m_state);
+
+        return tcs.as_task();
+    }
+
+    arcana::task<void, std::exception_ptr> AssetCache::PrefetchAsync(const std::vector<std::string>& paths)
+    {
+        if (paths.empty())
+        {
+            return arcana::task_from_result<std::exception_ptr>();
+        }
+
+        struct Prefetch final
+        {
+            std::mutex Mutex{};
+            size_t Remaining{};
+            std::exception_ptr Error{};
+            arcana::task_completion_source<void, std::exception_ptr> Tcs{};
+        };
+
+        auto prefetch{std::make_shared<Prefetch>()};
+        prefetch->Remaining = paths.size();
+
+        for (const auto& path : paths)
+        {
+            m_state->Load(path, [prefetch](const AssetPtr&, const std::exception_ptr& error) {
+                {
+                    std::lock_guard<std::mutex> guard{prefetch->Mutex};
+                    if (error && !prefetch->Error)
+                    {
+                        prefetch->Error = error;
+                    }
+
+                    if (--prefetch->Remaining != 0)
+                    {
+                        return;
+                    }
+                }
+
+                if (prefetch->Error)
+                {
+                    prefetch->Tcs.complete(arcana::make_unexpected(prefetch->Error));
+                }
+                else
+                {
+                    prefetch->Tcs.complete();
+                }
+            }, m_state);
+        }
+
+        return prefetch->Tcs.as_task();
+    }
+
+    AssetCache::AssetPtr AssetCache::TryGet(const std::string& path)
+    {
+        std::lock_guard<std::mutex> guard{m_state->Mutex};
+        auto entry{m_state->Entries.find(path)};
+        if (entry == m_state->Entries.end())
+        {
+            return {};
+        }
+
+        m_state->Touch(entry->second);
+        return entry->second->second;
+    }
+
+    size_t AssetCache::Trim(size_t bytesToRelease)
+    {
+        std::lock_guard<std::mutex> guard{m_state->Mutex};
+        return m_state->Evict(bytesToRelease);
+    }
+
+    size_t AssetCache::Size() const
+    {
+        std::lock_guard<std::mutex> guard{m_state->Mutex};
+        return m_state->Size;
+    }
+
+    size_t AssetCache::Capacity() const
+    {
+        return m_state->Capacity;
+    }
+}
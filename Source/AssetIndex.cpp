@@ -0,0 +1,207 @@
+#include <AndroidExtensions/AssetIndex.h>
+#include <AndroidExtensions/Globals.h>
+#include <android/asset_manager_jni.h>
+#include <unistd.h>
+#include <algorithm>
+#include <mutex>
+
+namespace android::Assets
+{
+    namespace
+    {
+        std::string_view GetDirectory(std::string_view path)
+        {
+            auto separator{path.rfind('/')};
+            return separator == std::string_view::npos ? std::string_view{} : path.substr(0, separator);
+        }
+
+        std::string Join(const std::string& directory, const std::string& name)
+        {
+            return directory.empty() ? name : directory + "/" + name;
+        }
+
+        bool MatchGlob(std::string_view pattern, std::string_view text)
+        {
+            while (!pattern.empty())
+            {
+                if (pattern[0] == '*')
+                {
+                    const bool crossSegments{pattern.size() > 1 && pattern[1] == '*'};
+                    pattern.remove_prefix(crossSegments ? 2 : 1);
+
+                    // Try every possible length for the wildcard, stopping at a separator unless it is '**'.
+                    for (size_t length = 0; length <= text.size(); ++length)
+                    {
+                        if (MatchGlob(pattern, text.substr(length)))
+                        {
+                            return true;
+                        }
+
+                        if (length < text.size() && text[length] == '/' && !crossSegments)
+                        {
+                            break;
+                        }
+                    }
+
+                    return false;
+                }
+
+                if (text.empty() || (pattern[0] != '?' && pattern[0] != text[0]) || (pattern[0] == '?' && text[0] == '/'))
+                {
+                    return false;
+                }
+
+                pattern.remove_prefix(1);
+                text.remove_prefix(1);
+            }
+
+            return text.empty();
+        }
+    }
+
+    AssetIndex::AssetIndex(const content::res::AssetManager& assetManager)
+        : m_assetManagerRef{global::GetEnvForCurrentThread()->NewGlobalRef(assetManager)}
+        , m_assetManager{AAssetManager_fromJava(global::GetEnvForCurrentThread(), m_assetManagerRef)}
+    {
+    }
+
+    AssetIndex::~AssetIndex()
+    {
+        global::GetEnvForCurrentThread()->DeleteGlobalRef(m_assetManagerRef);
+    }
+
+    void AssetIndex::IndexAll(const std::string& root)
+    {
+        // AAssetDir only reports files, so Java's AssetManager.list is used to discover subdirectories.
+        content::res::AssetManager assetManager{m_assetManagerRef};
+        std::vector<std::string> directories{root};
+
+        std::unique_lock<std::shared_mutex> lock{m_mutex};
+        while (!directories.empty())
+        {
+            std::string directory{std::move(directories.back())};
+            directories.pop_back();
+
+            IndexDirectory(directory);
+
+            for (const auto& name : assetManager.list(directory.c_str()))
+            {
+                std::string path{Join(directory, name)};
+                if (m_lookup.find(path) == m_lookup.end())
+                {
+                    directories.push_back(std::move(path));
+                }
+            }
+        }
+    }
+
+    std::optional<AssetIndex::Entry> AssetIndex::Find(std::string_view path)
+    {
+        EnsureDirectoryIndexed(GetDirectory(path));
+
+        std::shared_lock<std::shared_mutex> lock{m_mutex};
+        auto entry{m_lookup.find(path)};
+        if (entry == m_lookup.end())
+        {
+            return {};
+        }
+
+        return *entry->second;
+    }
+
+    bool AssetIndex::Exists(std::string_view path)
+    {
+        return Find(path).has_value();
+    }
+
+    std::vector<std::string> AssetIndex::Enumerate(std::string_view prefix)
+    {
+        EnsureDirectoryIndexed(GetDirectory(prefix));
+
+        std::vector<std::string> result{};
+        std::shared_lock<std::shared_mutex> lock{m_mutex};
+        for (auto entry{m_entries.lower_bound(prefix)}; entry != m_entries.end() && entry->first.compare(0, prefix.size(), prefix) == 0; ++entry)
+        {
+            result.push_back(entry->first);
+        }
+
+        return result;
+    }
+
+    std::vector<std::string> AssetIndex::Glob(std::string_view pattern)
+    {
+        // Only paths sharing the literal part of the pattern can match, which bounds the scan.
+        const std::string_view prefix{pattern.substr(0, pattern.find_first_of("*?"))};
+        EnsureDirectoryIndexed(GetDirectory(prefix));
+
+        std::vector<std::string> result{};
+        std::shared_lock<std::shared_mutex> lock{m_mutex};
+        for (auto entry{m_entries.lower_bound(prefix)}; entry != m_entries.end() && entry->first.compare(0, prefix.size(), prefix) == 0; ++entry)
+        {
+            if (MatchGlob(pattern, entry->first))
+            {
+                result.push_back(entry->first);
+            }
+        }
+
+        return result;
+    }
+
+    void AssetIndex::IndexDirectory(const std::string& directory)
+    {
+        if (!m_indexedDirectories.insert(directory).second)
+        {
+            return;
+        }
+
+        AAssetDir* assetDir{AAssetManager_openDir(m_assetManager, directory.c_str())};
+        if (!assetDir)
+        {
+            return;
+        }
+
+        while (const char* name{AAssetDir_getNextFileName(assetDir)})
+        {
+            std::string path{Join(directory, name)};
+
+            // Opening an asset in unknown mode does not read or decompress its contents.
+            AAsset* asset{AAssetManager_open(m_assetManager, path.c_str(), AASSET_MODE_UNKNOWN)};
+            if (!asset)
+            {
+                continue;
+            }
+
+            off64_t start{};
+            off64_t length{};
+            int fd{AAsset_openFileDescriptor64(asset, &start, &length)};
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+
+            Entry entry{static_cast<uint64_t>(AAsset_getLength64(asset)), fd < 0};
+            AAsset_close(asset);
+
+            auto inserted{m_entries.insert_or_assign(std::move(path), entry).first};
+            m_lookup[inserted->first] = &inserted->second;
+        }
+
+        AAssetDir_close(assetDir);
+    }
+
+    void AssetIndex::EnsureDirectoryIndexed(std::string_view directory)
+    {
+        std::string key{directory};
+
+        {
+            std::shared_lock<std::shared_mutex> lock{m_mutex};
+            if (m_indexedDirectories.count(key) != 0)
+            {
+                return;
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> lock{m_mutex};
+        IndexDirectory(key);
+    }
+}
@@ -0,0 +1,155 @@
+#include <AndroidExtensions/Assets.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace android::Assets
+{
+    Asset::Asset(AAssetManager* assetManager, const char* path, AccessMode mode)
+        : m_asset{AAssetManager_open(assetManager, path, mode == AccessMode::Random ? AASSET_MODE_RANDOM : mode == AccessMode::Streaming ? AASSET_MODE_STREAMING : AASSET_MODE_BUFFER)}
+    {
+        if (!m_asset)
+        {
+            throw std::runtime_error{std::string{"Failed to open asset "} + path};
+        }
+
+        m_size = static_cast<size_t>(AAsset_getLength64(m_asset));
+
+        // A file descriptor can only be obtained for assets that are stored uncompressed in the APK.
+        off64_t start{};
+        off64_t length{};
+        int fd{AAsset_openFileDescriptor64(m_asset, &start, &length)};
+        m_compressed = fd < 0;
+
+        if (!m_compressed && mode != AccessMode::Buffer && m_size > 0)
+        {
+            // Mappings have to start on a page boundary, while assets are not necessarily page aligned within the APK.
+            const off64_t pageSize{sysconf(_SC_PAGESIZE)};
+            const off64_t alignedStart{start - start % pageSize};
+            const size_t offset{static_cast<size_t>(start - alignedStart)};
+
+            void* mapping{mmap64(nullptr, offset + m_size, PROT_READ, MAP_PRIVATE, fd, alignedStart)};
+            if (mapping != MAP_FAILED)
+            {
+                m_mapping = mapping;
+                m_mappingSize = offset + m_size;
+                m_data = static_cast<const std::byte*>(mapping) + offset;
+                madvise(m_mapping, m_mappingSize, mode == AccessMode::Random ? MADV_RANDOM : MADV_SEQUENTIAL);
+            }
+        }
+
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+
+        if (!m_data && (mode != AccessMode::Streaming || !m_compressed))
+        {
+            // For uncompressed assets this points straight into the mapped APK, for compressed ones the
+            // asset is decompressed once into a buffer owned by the AAsset.
+            m_data = static_cast<const std::byte*>(AAsset_getBuffer(m_asset));
+            if (!m_data && m_size > 0)
+            {
+                Close();
+                throw std::runtime_error{std::string{"Failed to read asset "} + path};
+            }
+        }
+    }
+
+    Asset::~Asset()
+    {
+        Close();
+    }
+
+    Asset::Asset(Asset&& other) noexcept
+        : m_asset{std::exchange(other.m_asset, nullptr)}
+        , m_mapping{std::exchange(other.m_mapping, nullptr)}
+        , m_mappingSize{std::exchange(other.m_mappingSize, 0)}
+        , m_data{std::exchange(other.m_data, nullptr)}
+        , m_size{std::exchange(other.m_size, 0)}
+        , m_position{std::exchange(other.m_position, 0)}
+        , m_compressed{other.m_compressed}
+    {
+    }
+
+    Asset& Asset::operator=(Asset&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Close();
+            m_asset = std::exchange(other.m_asset, nullptr);
+            m_mapping = std::exchange(other.m_mapping, nullptr);
+            m_mappingSize = std::exchange(other.m_mappingSize, 0);
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_position = std::exchange(other.m_position, 0);
+            m_compressed = other.m_compressed;
+        }
+
+        return *this;
+    }
+
+    size_t Asset::Size() const
+    {
+        return m_size;
+    }
+
+    bool Asset::IsCompressed() const
+    {
+        return m_compressed;
+    }
+
+    gsl::span<const std::byte> Asset::Data() const
+    {
+        return m_data ? gsl::span<const std::byte>{m_data, m_size} : gsl::span<const std::byte>{};
+    }
+
+    size_t Asset::Read(gsl::span<std::byte> buffer)
+    {
+        if (m_data)
+        {
+            const size_t count{std::min(buffer.size(), m_size - m_position)};
+            std::memcpy(buffer.data(), m_data + m_position, count);
+            m_position += count;
+            return count;
+        }
+
+        int count{AAsset_read(m_asset, buffer.data(), buffer.size())};
+        if (count < 0)
+        {
+            throw std::runtime_error{"Failed to read asset"};
+        }
+
+        m_position += static_cast<size_t>(count);
+        return static_cast<size_t>(count);
+    }
+
+    void Asset::Prefetch() const
+    {
+        if (m_mapping)
+        {
+            madvise(m_mapping, m_mappingSize, MADV_WILLNEED);
+        }
+    }
+
+    void Asset::Close()
+    {
+        if (m_mapping)
+        {
+            munmap(m_mapping, m_mappingSize);
+            m_mapping = nullptr;
+        }
+
+        if (m_asset)
+        {
+            AAsset_close(m_asset);
+            m_asset = nullptr;
+        }
+
+        m_data = nullptr;
+    }
+}
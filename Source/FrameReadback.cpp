@@ -0,0 +1,280 @@
+#include <AndroidExtensions/FrameReadback.h>
+#include <AndroidExtensions/ShaderLibrary.h>
+#include <AndroidExtensions/StateScope.h>
+#include <iterator>
+#include <stdexcept>
+
+namespace android::OpenGLHelpers
+{
+    namespace
+    {
+        // Draws a quad covering the target from gl_VertexID, so no vertex buffers are needed.
+        constexpr const char* VERTEX_SHADER{R"(#version 300 es
+out vec2 v_position;
+void main()
+{
+    v_position = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+    gl_Position = vec4(v_position * 2.0 - 1.0, 0.0, 1.0);
+}
+)"};
+
+        // The transform is applied per sample rather than per vertex, since packed luma samples several source
+        // pixels per fragment. The vertical flip makes the first row read back the top of the image.
+        constexpr const char* FRAGMENT_SHADER{R"(#version 300 es
+#ifdef EXTERNAL_SOURCE
+#extension GL_OES_EGL_image_external_essl3 : require
+#define SAMPLER samplerExternalOES
+#else
+#define SAMPLER sampler2D
+#endif
+// Sample positions need full precision, since mediump cannot address individual texels past about 1024 pixels.
+precision highp float;
+uniform SAMPLER u_texture;
+uniform mat4 u_transform;
+in vec2 v_position;
+out vec4 o_color;
+
+vec4 Sample(vec2 position)
+{
+    return texture(u_texture, (u_transform * vec4(position.x, 1.0 - position.y, 0.0, 1.0)).xy);
+}
+
+#ifdef LUMINANCE
+uniform float u_width;
+
+float Luma(vec2 position)
+{
+    return dot(Sample(position).rgb, vec3(0.299, 0.587, 0.114));
+}
+
+void main()
+{
+    float x = floor(gl_FragCoord.x) * 4.0;
+    o_color = vec4(
+        Luma(vec2((x + 0.5) / u_width, v_position.y)),
+        Luma(vec2((x + 1.5) / u_width, v_position.y)),
+        Luma(vec2((x + 2.5) / u_width, v_position.y)),
+        Luma(vec2((x + 3.5) / u_width, v_position.y)));
+}
+#else
+void main()
+{
+    o_color = Sample(v_position);
+}
+#endif
+)"};
+
+        constexpr GLfloat IDENTITY[16]{
+            1.0f, 0.0f, 0.0f, 0.0f,
+            0.0f, 1.0f, 0.0f, 0.0f,
+            0.0f, 0.0f, 1.0f, 0.0f,
+            0.0f, 0.0f, 0.0f, 1.0f,
+        };
+
+        // Pack state that changes how rows are written to the pixel pack buffers, which expect tightly packed rows.
+        // These are reset while reading; the alignment is set to 1 and everything else to 0.
+        constexpr GLenum PACK_PARAMETERS[]{
+            GL_PACK_ALIGNMENT,
+            GL_PACK_ROW_LENGTH,
+            GL_PACK_SKIP_ROWS,
+            GL_PACK_SKIP_PIXELS,
+        };
+    }
+
+    FrameReadback::FrameReadback(GLsizei width, GLsizei height, PixelFormat format, FrameCallback callback, size_t ringSize, GLenum sourceTarget)
+        : m_width{width}
+        , m_height{height}
+        , m_format{format}
+        , m_sourceTarget{sourceTarget}
+        , m_callback{std::move(callback)}
+        , m_targetWidth{format == PixelFormat::Luminance ? width / 4 : width}
+        , m_slots(ringSize)
+    {
+        if (width <= 0 || height <= 0 || ringSize == 0)
+        {
+            throw std::invalid_argument{"FrameReadback requires a non-empty size and at least one buffer"};
+        }
+
+        if (format == PixelFormat::Luminance && width % 4 != 0)
+        {
+            throw std::invalid_argument{"FrameReadback luminance width must be a multiple of four"};
+        }
+
+        if (sourceTarget != GL_TEXTURE_EXTERNAL_OES && sourceTarget != GL_TEXTURE_2D)
+        {
+            throw std::invalid_argument{"FrameReadback only supports external and 2D source textures"};
+        }
+
+        ShaderLibrary::Defines defines{};
+        if (sourceTarget == GL_TEXTURE_EXTERNAL_OES)
+        {
+            defines.emplace("EXTERNAL_SOURCE", "");
+        }
+
+        if (format == PixelFormat::Luminance)
+        {
+            defines.emplace("LUMINANCE", "");
+        }
+
+        try
+        {
+            m_program = CreateShaderProgram(VERTEX_SHADER, ShaderLibrary::Preprocess(FRAGMENT_SHADER, defines).c_str());
+            m_transformLocation = glGetUniformLocation(m_program, "u_transform");
+
+            GLTransactions::StateScope scope{};
+            scope.UseProgram(m_program);
+            glUniform1i(glGetUniformLocation(m_program, "u_texture"), 0);
+            if (format == PixelFormat::Luminance)
+            {
+                glUniform1f(glGetUniformLocation(m_program, "u_width"), static_cast<GLfloat>(width));
+            }
+
+            glGenVertexArrays(1, &m_vertexArray);
+
+            glGenTextures(1, &m_texture);
+            scope.BindTexture(GL_TEXTURE0, GL_TEXTURE_2D, m_texture);
+            glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, m_targetWidth, m_height);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+            glGenFramebuffers(1, &m_framebuffer);
+            scope.BindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texture, 0);
+            if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            {
+                throw std::runtime_error{"FrameReadback render target is incomplete"};
+            }
+
+            const auto frameSize{static_cast<GLsizeiptr>(m_targetWidth) * m_height * 4};
+            for (auto& slot : m_slots)
+            {
+                glGenBuffers(1, &slot.Buffer);
+                scope.BindBuffer(GL_PIXEL_PACK_BUFFER, slot.Buffer);
+                glBufferData(GL_PIXEL_PACK_BUFFER, frameSize, nullptr, GL_STREAM_READ);
+            }
+        }
+        catch (...)
+        {
+            Destroy();
+            throw;
+        }
+    }
+
+    FrameReadback::~FrameReadback()
+    {
+        Destroy();
+    }
+
+    void FrameReadback::Capture(GLuint texture, const float* transformMatrix, int64_t timestamp)
+    {
+        Poll();
+
+        ++m_captured;
+
+        Slot& slot{m_slots[m_nextSlot]};
+        if (slot.Fence)
+        {
+            // The oldest readback is still in flight, and waiting for it would stall the GL thread.
+            ++m_dropped;
+            return;
+        }
+
+        GLTransactions::StateScope scope{};
+        scope.BindFramebuffer(GL_FRAMEBUFFER, m_framebuffer)
+            .SetViewport({0, 0, m_targetWidth, m_height})
+            .SetEnabled(GL_BLEND, false)
+            .SetEnabled(GL_DEPTH_TEST, false)
+            .SetEnabled(GL_STENCIL_TEST, false)
+            .SetEnabled(GL_SCISSOR_TEST, false)
+            .SetEnabled(GL_CULL_FACE, false)
+            .UseProgram(m_program)
+            .BindVertexArray(m_vertexArray)
+            .BindTexture(GL_TEXTURE0, m_sourceTarget, texture);
+
+        glUniformMatrix4fv(m_transformLocation, 1, GL_FALSE, transformMatrix ? transformMatrix : IDENTITY);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+        // The read returns immediately; the copy into the buffer completes asynchronously on the GPU.
+        // The pack state is not shadowed, so it is queried for every capture.
+        GLint previousPack[std::size(PACK_PARAMETERS)]{};
+        for (size_t index = 0; index < std::size(PACK_PARAMETERS); ++index)
+        {
+            glGetIntegerv(PACK_PARAMETERS[index], &previousPack[index]);
+            glPixelStorei(PACK_PARAMETERS[index], PACK_PARAMETERS[index] == GL_PACK_ALIGNMENT ? 1 : 0);
+        }
+
+        scope.BindBuffer(GL_PIXEL_PACK_BUFFER, slot.Buffer);
+        glReadPixels(0, 0, m_targetWidth, m_height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+        for (size_t index = 0; index < std::size(PACK_PARAMETERS); ++index)
+        {
+            glPixelStorei(PACK_PARAMETERS[index], previousPack[index]);
+        }
+
+        slot.Fence = Fence::Insert();
+        slot.Timestamp = timestamp;
+        m_inFlight.push_back(m_nextSlot);
+        m_nextSlot = (m_nextSlot + 1) % m_slots.size();
+    }
+
+    void FrameReadback::Poll()
+    {
+        if (m_inFlight.empty())
+        {
+            return;
+        }
+
+        GLTransactions::StateScope scope{};
+        while (!m_inFlight.empty())
+        {
+            Slot& slot{m_slots[m_inFlight.front()]};
+            if (!slot.Fence.IsSignaled())
+            {
+                break;
+            }
+
+            m_inFlight.pop_front();
+            slot.Fence = {};
+
+            const auto frameSize{static_cast<size_t>(m_targetWidth) * m_height * 4};
+            scope.BindBuffer(GL_PIXEL_PACK_BUFFER, slot.Buffer);
+            const auto* mapped{static_cast<const std::byte*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(frameSize), GL_MAP_READ_BIT))};
+            if (!mapped)
+            {
+                continue;
+            }
+
+            auto unmap{gsl::finally([]() { glUnmapBuffer(GL_PIXEL_PACK_BUFFER); })};
+
+            const size_t bytesPerPixel{m_format == PixelFormat::Luminance ? size_t{1} : size_t{4}};
+            ++m_delivered;
+            m_callback({{mapped, frameSize}, m_width, m_height, static_cast<size_t>(m_width) * bytesPerPixel, slot.Timestamp});
+        }
+    }
+
+    FrameReadback::Statistics FrameReadback::GetStatistics() const
+    {
+        return {m_captured, m_delivered, m_dropped};
+    }
+
+    void FrameReadback::Destroy()
+    {
+        // Names that were never created are zero, which GL ignores.
+        StateShadow& state{StateShadow::Current()};
+        for (auto& slot : m_slots)
+        {
+            state.DeleteBuffers(1, &slot.Buffer);
+        }
+
+        state.DeleteFramebuffers(1, &m_framebuffer);
+        state.DeleteTextures(1, &m_texture);
+        state.DeleteVertexArrays(1, &m_vertexArray);
+
+        if (state.GetProgram() == m_program)
+        {
+            state.UseProgram(0);
+        }
+
+        glDeleteProgram(m_program);
+    }
+}
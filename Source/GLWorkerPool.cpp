@@ -0,0 +1,283 @@
+#include <AndroidExtensions/GLWorkerPool.h>
+#include <pthread.h>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace android::OpenGLHelpers
+{
+    namespace
+    {
+        bool HasDisplayExtension(EGLDisplay display, const char* name)
+        {
+            const char* extensions{eglQueryString(display, EGL_EXTENSIONS)};
+            if (!extensions)
+            {
+                return false;
+            }
+
+            const size_t length{std::strlen(name)};
+            for (const char* position{extensions}; (position = std::strstr(position, name)) != nullptr; position += length)
+            {
+                const bool startsToken{position == extensions || position[-1] == ' '};
+                const bool endsToken{position[length] == ' ' || position[length] == '\0'};
+                if (startsToken && endsToken)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        std::string GetEGLError(const char* message)
+        {
+            char error[16]{};
+            std::snprintf(error, sizeof(error), "0x%04X", eglGetError());
+            return std::string{message} + " (EGL error " + error + ")";
+        }
+    }
+
+    Fence::Fence(GLsync sync)
+        : m_sync{sync}
+    {
+    }
+
+    Fence::~Fence()
+    {
+        if (m_sync)
+        {
+            glDeleteSync(m_sync);
+        }
+    }
+
+    Fence::Fence(Fence&& other) noexcept
+        : m_sync{std::exchange(other.m_sync, nullptr)}
+    {
+    }
+
+    Fence& Fence::operator=(Fence&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_sync)
+            {
+                glDeleteSync(m_sync);
+            }
+
+            m_sync = std::exchange(other.m_sync, nullptr);
+        }
+
+        return *this;
+    }
+
+    Fence Fence::Insert()
+    {
+        GLsync sync{ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) };
+        if (!sync)
+        {
+            throw std::runtime_error{"Failed to create fence"};
+        }
+
+        glFlush();
+        return Fence{sync};
+    }
+
+    Fence::operator bool() const
+    {
+        return m_sync != nullptr;
+    }
+
+    bool Fence::IsSignaled() const
+    {
+        GLint status{ GL_UNSIGNALED };
+        glGetSynciv(m_sync, GL_SYNC_STATUS, 1, nullptr, &status);
+        return status == GL_SIGNALED;
+    }
+
+    bool Fence::ClientWait(std::chrono::nanoseconds timeout) const
+    {
+        const GLenum result{ glClientWaitSync(m_sync, 0, static_cast<GLuint64>(timeout.count())) };
+        return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+    }
+
+    void Fence::Wait() const
+    {
+        glWaitSync(m_sync, 0, GL_TIMEOUT_IGNORED);
+    }
+
+    GLWorkerPool::GLWorkerPool(EGLDisplay display, EGLContext shareContext, size_t threadCount, std::string name)
+        : m_display{display}
+        , m_name{std::move(name)}
+    {
+        if (threadCount == 0)
+        {
+            throw std::invalid_argument{"GLWorkerPool requires at least one thread"};
+        }
+
+        // Shared contexts have to use the same client API version, and a matching config is the safest choice.
+        EGLint configId{};
+        EGLint clientVersion{};
+        if (!eglQueryContext(display, shareContext, EGL_CONFIG_ID, &configId) ||
+            !eglQueryContext(display, shareContext, EGL_CONTEXT_CLIENT_VERSION, &clientVersion))
+        {
+            throw std::runtime_error{GetEGLError("Failed to query the share context")};
+        }
+
+        const EGLint configAttributes[]{EGL_CONFIG_ID, configId, EGL_NONE};
+        EGLConfig config{};
+        EGLint configCount{};
+        if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+        {
+            throw std::runtime_error{GetEGLError("Failed to find the config of the share context")};
+        }
+
+        const bool surfaceless{HasDisplayExtension(display, "EGL_KHR_surfaceless_context")};
+        const EGLint contextAttributes[]{EGL_CONTEXT_CLIENT_VERSION, clientVersion, EGL_NONE};
+        const EGLint surfaceAttributes[]{EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+
+        try
+        {
+            for (size_t index = 0; index < threadCount; ++index)
+            {
+                m_workers.push_back(std::make_unique<Worker>());
+                Worker& worker{*m_workers.back()};
+
+                worker.Context = eglCreateContext(display, config, shareContext, contextAttributes);
+                if (worker.Context == EGL_NO_CONTEXT)
+                {
+                    throw std::runtime_error{GetEGLError("Failed to create a shared context")};
+                }
+
+                if (!surfaceless)
+                {
+                    worker.Surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+                    if (worker.Surface == EGL_NO_SURFACE)
+                    {
+                        throw std::runtime_error{GetEGLError("Failed to create a pbuffer surface")};
+                    }
+                }
+            }
+        }
+        catch (...)
+        {
+            Destroy();
+            throw;
+        }
+
+        for (size_t index = 0; index < threadCount; ++index)
+        {
+            m_workers[index]->Thread = std::thread{[this, index]() { Run(*m_workers[index], index); }};
+        }
+
+        std::unique_lock<std::mutex> lock{m_mutex};
+        m_condition.wait(lock, [this]() { return m_started == m_workers.size(); });
+        if (!m_startError.empty())
+        {
+            lock.unlock();
+            Destroy();
+            throw std::runtime_error{m_startError};
+        }
+    }
+
+    GLWorkerPool::~GLWorkerPool()
+    {
+        Destroy();
+    }
+
+    size_t GLWorkerPool::QueueDepth() const
+    {
+        std::lock_guard<std::mutex> guard{m_mutex};
+        return m_queue.size();
+    }
+
+    void GLWorkerPool::Enqueue(Work&& work)
+    {
+        {
+            std::lock_guard<std::mutex> guard{m_mutex};
+            m_queue.push_back(std::move(work));
+        }
+
+        m_condition.notify_one();
+    }
+
+    void GLWorkerPool::Run(Worker& worker, size_t index)
+    {
+        const std::string threadName{m_name + "-" + std::to_string(index)};
+        pthread_setname_np(pthread_self(), threadName.substr(0, 15).c_str());
+
+        const bool current{StateShadow::SetEGLBinding({m_display, worker.Surface, worker.Surface, worker.Context})};
+        {
+            std::lock_guard<std::mutex> guard{m_mutex};
+            if (!current && m_startError.empty())
+            {
+                m_startError = GetEGLError("Failed to make a shared context current");
+            }
+
+            ++m_started;
+        }
+
+        m_condition.notify_all();
+
+        while (current)
+        {
+            Work work{};
+            {
+                std::unique_lock<std::mutex> lock{m_mutex};
+                m_condition.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+                if (m_queue.empty())
+                {
+                    break;
+                }
+
+                work = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+
+            // Tasks report their failures through their own continuations, and anything escaping here would
+            // terminate the process and take the worker's context with it.
+            try
+            {
+                work();
+            }
+            catch (...)
+            {
+            }
+        }
+
+        StateShadow::SetEGLBinding({m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT});
+        eglReleaseThread();
+    }
+
+    void GLWorkerPool::Destroy()
+    {
+        {
+            std::lock_guard<std::mutex> guard{m_mutex};
+            m_stopping = true;
+        }
+
+        m_condition.notify_all();
+
+        for (auto& worker : m_workers)
+        {
+            if (worker->Thread.joinable())
+            {
+                worker->Thread.join();
+            }
+
+            if (worker->Surface != EGL_NO_SURFACE)
+            {
+                eglDestroySurface(m_display, worker->Surface);
+            }
+
+            if (worker->Context != EGL_NO_CONTEXT)
+            {
+                StateShadow::ContextDestroyed(worker->Context);
+                eglDestroyContext(m_display, worker->Context);
+            }
+        }
+
+        m_workers.clear();
+    }
+}
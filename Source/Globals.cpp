@@ -1,4 +1,10 @@
 #include <AndroidExtensions/Globals.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <gsl/gsl>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 
 namespace android::global
@@ -9,43 +15,144 @@ namespace android::global
         jobject g_appContext{};
         jobject g_currentActivity{};
 
+        std::atomic<uint64_t> g_attachCount{};
+        std::atomic<uint64_t> g_detachCount{};
+
         thread_local struct Env final
         {
             ~Env()
+            {
+                Detach();
+            }
+
+            void Detach()
             {
                 if (m_attached)
                 {
                     g_javaVM->DetachCurrentThread();
+                    g_detachCount.fetch_add(1, std::memory_order_relaxed);
+                    m_attached = false;
                 }
+
+                m_env = nullptr;
             }
 
+            // The JNIEnv is only valid on the thread it was obtained on, and stays valid until that thread
+            // is detached, so it is safe to cache per thread.
+            JNIEnv* m_env{};
             bool m_attached{};
         } g_env{};
 
+        // Registrations whose handlers are running on this thread, innermost last.
+        thread_local std::vector<const void*> t_runningHandlers{};
+
         template<typename ... Args>
         class Event final
         {
         public:
             using Handler = std::function<void(Args ...)>;
-            using Ticket = typename arcana::ticketed_collection<Handler>::ticket;
-            Ticket AddHandler(Handler&& handler)
+            using Ticket = CallbackTicket;
+
+            Ticket AddHandler(Handler&& handler, CallbackDispatcher&& dispatcher = {})
             {
-                std::lock_guard<std::recursive_mutex> guard{m_mutex};
-                return m_handlers.insert(handler, m_mutex);
+                auto registration{std::make_shared<Registration>(std::move(handler), std::move(dispatcher))};
+
+                std::lock_guard<std::mutex> guard{m_mutex};
+                auto handlers{std::make_shared<Handlers>(*std::atomic_load(&m_handlers))};
+                handlers->push_back(registration);
+                std::atomic_store(&m_handlers, std::shared_ptr<const Handlers>{std::move(handlers)});
+
+                return Ticket{[this, registration]() { RemoveHandler(registration); }};
             }
 
             void Fire(Args ... args)
             {
-                std::lock_guard<std::recursive_mutex> guard{m_mutex};
-                for (auto& handler : m_handlers)
+                // Handlers run against an immutable snapshot, so no lock is held while they execute and
+                // they are free to add or remove handlers, which only affects subsequent calls to Fire.
+                const auto handlers{std::atomic_load(&m_handlers)};
+                for (const auto& registration : *handlers)
                 {
-                    handler(args ...);
+                    if (registration->Dispatcher)
+                    {
+                        registration->Dispatcher([registration, args ...]()
+                        {
+                            Invoke(*registration, args ...);
+                        });
+                    }
+                    else
+                    {
+                        Invoke(*registration, args ...);
+                    }
                 }
             }
 
         private:
-            std::recursive_mutex m_mutex{};
-            arcana::ticketed_collection<Handler, std::recursive_mutex> m_handlers{};
+            struct Registration final
+            {
+                Registration(Handler&& callback, CallbackDispatcher&& dispatcher)
+                    : Callback{std::move(callback)}
+                    , Dispatcher{std::move(dispatcher)}
+                {
+                }
+
+                const Handler Callback;
+                const CallbackDispatcher Dispatcher;
+
+                std::mutex Mutex{};
+                std::condition_variable Idle{};
+                bool Active{true};
+                size_t InFlight{};
+            };
+
+            using Handlers = std::vector<std::shared_ptr<Registration>>;
+
+            static void Invoke(Registration& registration, Args ... args)
+            {
+                {
+                    std::lock_guard<std::mutex> guard{registration.Mutex};
+                    if (!registration.Active)
+                    {
+                        return;
+                    }
+
+                    ++registration.InFlight;
+                }
+
+                t_runningHandlers.push_back(&registration);
+                auto finished{gsl::finally([&registration]() {
+                    t_runningHandlers.pop_back();
+                    {
+                        std::lock_guard<std::mutex> guard{registration.Mutex};
+                        --registration.InFlight;
+                    }
+
+                    registration.Idle.notify_all();
+                })};
+
+                registration.Callback(args ...);
+            }
+
+            void RemoveHandler(const std::shared_ptr<Registration>& registration)
+            {
+                // Snapshots taken before removal may still reference the registration, so it is marked inactive,
+                // and calls already in progress on other threads are waited for, so the handler is never running
+                // once its ticket has been released. A handler that releases its own ticket cannot wait for itself.
+                {
+                    std::unique_lock<std::mutex> lock{registration->Mutex};
+                    registration->Active = false;
+
+                    const auto ownCalls{static_cast<size_t>(std::count(t_runningHandlers.begin(), t_runningHandlers.end(), registration.get()))};
+                    registration->Idle.wait(lock, [&registration, ownCalls]() { return registration->InFlight == ownCalls; });
+                }
+
+                std::lock_guard<std::mutex> guard{m_mutex};
+                auto handlers{std::make_shared<Handlers>(*std::atomic_load(&m_handlers))};
+                handlers->erase(std::remove(handlers->begin(), handlers->end(), registration), handlers->end());
+                std::atomic_store(&m_handlers, std::shared_ptr<const Handlers>{std::move(handlers)});
+            }
+
+            std::mutex m_mutex{};
+            std::shared_ptr<const Handlers> m_handlers{std::make_shared<const Handlers>()};
         };
 
         using AppStateChangedEvent = Event<>;
@@ -54,6 +161,47 @@ namespace android::global
 
         using RequestPermissionsResultEvent = Event<int32_t, const std::vector<std::string>&, const std::vector<int32_t>&>;
         RequestPermissionsResultEvent g_requestPermissionsResultEvent{};
+
+        using TrimMemoryEvent = Event<int32_t>;
+        TrimMemoryEvent g_trimMemoryEvent{};
+
+        // ComponentCallbacks2.TRIM_MEMORY_COMPLETE
+        constexpr int32_t TRIM_MEMORY_COMPLETE{80};
+    }
+
+    CallbackTicket::CallbackTicket(std::function<void()> unregister)
+        : m_unregister{std::move(unregister)}
+    {
+    }
+
+    CallbackTicket::~CallbackTicket()
+    {
+        if (m_unregister)
+        {
+            m_unregister();
+        }
+    }
+
+    CallbackTicket::CallbackTicket(CallbackTicket&& other) noexcept
+        : m_unregister{std::move(other.m_unregister)}
+    {
+        other.m_unregister = nullptr;
+    }
+
+    CallbackTicket& CallbackTicket::operator=(CallbackTicket&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_unregister)
+            {
+                m_unregister();
+            }
+
+            m_unregister = std::move(other.m_unregister);
+            other.m_unregister = nullptr;
+        }
+
+        return *this;
     }
 
     void Initialize(JavaVM* javaVM, jobject context)
@@ -64,6 +212,11 @@ namespace android::global
 
     JNIEnv* GetEnvForCurrentThread()
     {
+        if (g_env.m_env)
+        {
+            return g_env.m_env;
+        }
+
         JNIEnv* env{};
 
         if (g_javaVM->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) == JNI_EDETACHED)
@@ -73,11 +226,44 @@ namespace android::global
             }
 
             g_env.m_attached = true;
+            g_attachCount.fetch_add(1, std::memory_order_relaxed);
         }
 
+        g_env.m_env = env;
         return env;
     }
 
+    JNIEnv* AttachCurrentThread(const char* threadName, bool asDaemon)
+    {
+        JNIEnv* env{};
+
+        if (g_javaVM->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) == JNI_EDETACHED)
+        {
+            JavaVMAttachArgs args{JNI_VERSION_1_6, threadName, nullptr};
+            auto result{asDaemon ? g_javaVM->AttachCurrentThreadAsDaemon(&env, &args) : g_javaVM->AttachCurrentThread(&env, &args)};
+            if (result != JNI_OK)
+            {
+                throw std::runtime_error(std::string{"Failed to attach thread "} + threadName + " to Java VM");
+            }
+
+            g_env.m_attached = true;
+            g_attachCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        g_env.m_env = env;
+        return env;
+    }
+
+    void DetachCurrentThread()
+    {
+        g_env.Detach();
+    }
+
+    ThreadAttachStatistics GetThreadAttachStatistics()
+    {
+        return {g_attachCount.load(std::memory_order_relaxed), g_detachCount.load(std::memory_order_relaxed)};
+    }
+
     android::content::Context GetAppContext()
     {
         return {g_appContext};
@@ -108,6 +294,11 @@ namespace android::global
         return g_pauseEvent.AddHandler(std::move(onPause));
     }
 
+    AppStateChangedEvent::Ticket AddPauseCallback(AppStateChangedEvent::Handler&& onPause, CallbackDispatcher dispatcher)
+    {
+        return g_pauseEvent.AddHandler(std::move(onPause), std::move(dispatcher));
+    }
+
     void Resume()
     {
         g_resumeEvent.Fire();
@@ -118,6 +309,11 @@ namespace android::global
         return g_resumeEvent.AddHandler(std::move(onResume));
     }
 
+    AppStateChangedEvent::Ticket AddResumeCallback(AppStateChangedEvent::Handler&& onResume, CallbackDispatcher dispatcher)
+    {
+        return g_resumeEvent.AddHandler(std::move(onResume), std::move(dispatcher));
+    }
+
     void RequestPermissionsResult(int32_t requestCode, const std::vector<std::string>& permissions, const std::vector<int32_t>& grantResults)
     {
         g_requestPermissionsResultEvent.Fire(requestCode, permissions, grantResults);
@@ -127,4 +323,29 @@ namespace android::global
     {
         return g_requestPermissionsResultEvent.AddHandler(std::move(onAddRequestPermissionsResult));
     }
+
+    RequestPermissionsResultEvent::Ticket AddRequestPermissionsResultCallback(RequestPermissionsResultEvent::Handler&& onAddRequestPermissionsResult, CallbackDispatcher dispatcher)
+    {
+        return g_requestPermissionsResultEvent.AddHandler(std::move(onAddRequestPermissionsResult), std::move(dispatcher));
+    }
+
+    void TrimMemory(int32_t level)
+    {
+        g_trimMemoryEvent.Fire(level);
+    }
+
+    void LowMemory()
+    {
+        g_trimMemoryEvent.Fire(TRIM_MEMORY_COMPLETE);
+    }
+
+    TrimMemoryEvent::Ticket AddTrimMemoryCallback(TrimMemoryEvent::Handler&& onTrimMemory)
+    {
+        return g_trimMemoryEvent.AddHandler(std::move(onTrimMemory));
+    }
+
+    TrimMemoryEvent::Ticket AddTrimMemoryCallback(TrimMemoryEvent::Handler&& onTrimMemory, CallbackDispatcher dispatcher)
+    {
+        return g_trimMemoryEvent.AddHandler(std::move(onTrimMemory), std::move(dispatcher));
+    }
 }
@@ -0,0 +1,168 @@
+#include <AndroidExtensions/JavaThreadPool.h>
+#include <AndroidExtensions/Globals.h>
+#include <gsl/gsl>
+#include <stdexcept>
+
+namespace android
+{
+    namespace
+    {
+        // Identifies the pool and worker the current thread belongs to, so work queued from inside
+        // a task stays on the queue of the worker that produced it.
+        thread_local const JavaThreadPool* t_currentPool{};
+        thread_local size_t t_currentWorker{};
+    }
+
+    JavaThreadPool::JavaThreadPool(size_t threadCount, std::string name, int localFrameCapacity)
+        : m_name{std::move(name)}
+        , m_localFrameCapacity{localFrameCapacity}
+    {
+        if (threadCount == 0)
+        {
+            throw std::invalid_argument{"JavaThreadPool requires at least one thread"};
+        }
+
+        m_workers.reserve(threadCount);
+        for (size_t index = 0; index < threadCount; ++index)
+        {
+            m_workers.push_back(std::make_unique<Worker>());
+        }
+
+        for (size_t index = 0; index < threadCount; ++index)
+        {
+            m_workers[index]->Thread = std::thread{[this, index]() { Run(index); }};
+        }
+    }
+
+    JavaThreadPool::~JavaThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> guard{m_idleMutex};
+            m_stopping = true;
+        }
+
+        m_idleCondition.notify_all();
+
+        for (auto& worker : m_workers)
+        {
+            worker->Thread.join();
+        }
+    }
+
+    size_t JavaThreadPool::QueueDepth() const
+    {
+        return m_pending.load(std::memory_order_relaxed);
+    }
+
+    JavaThreadPool::Statistics JavaThreadPool::GetStatistics() const
+    {
+        return {QueueDepth(), m_executed.load(std::memory_order_relaxed), m_stolen.load(std::memory_order_relaxed)};
+    }
+
+    void JavaThreadPool::Enqueue(Work&& work)
+    {
+        size_t index{t_currentPool == this ? t_currentWorker : m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_workers.size()};
+
+        // Counted before the push, so a worker that dequeues the work right away cannot take the count below zero.
+        {
+            std::lock_guard<std::mutex> guard{m_idleMutex};
+            m_pending.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        {
+            std::lock_guard<std::mutex> guard{m_workers[index]->Mutex};
+            m_workers[index]->Queue.push_back(std::move(work));
+        }
+
+        m_idleCondition.notify_one();
+    }
+
+    bool JavaThreadPool::TryDequeue(size_t index, Work& work)
+    {
+        // The owner takes its most recently queued work, which is most likely to still be in cache.
+        {
+            auto& worker{*m_workers[index]};
+            std::lock_guard<std::mutex> guard{worker.Mutex};
+            if (!worker.Queue.empty())
+            {
+                work = std::move(worker.Queue.back());
+                worker.Queue.pop_back();
+                return true;
+            }
+        }
+
+        // Otherwise steal the oldest work from another worker.
+        for (size_t offset = 1; offset < m_workers.size(); ++offset)
+        {
+            auto& victim{*m_workers[(index + offset) % m_workers.size()]};
+            std::lock_guard<std::mutex> guard{victim.Mutex};
+            if (!victim.Queue.empty())
+            {
+                work = std::move(victim.Queue.front());
+                victim.Queue.pop_front();
+                m_stolen.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void JavaThreadPool::Run(size_t index)
+    {
+        t_currentPool = this;
+        t_currentWorker = index;
+
+        const std::string threadName{m_name + "-" + std::to_string(index)};
+        JNIEnv* env{global::AttachCurrentThread(threadName.c_str())};
+        auto detach{gsl::finally([]() { global::DetachCurrentThread(); })};
+
+        while (true)
+        {
+            Work work{};
+            if (TryDequeue(index, work))
+            {
+                m_pending.fetch_sub(1, std::memory_order_relaxed);
+
+                // If the frame cannot be allocated the work still runs, with its references left to the thread.
+                const bool pushedFrame{env->PushLocalFrame(m_localFrameCapacity) == 0};
+                if (!pushedFrame)
+                {
+                    env->ExceptionClear();
+                }
+
+                auto popFrame{gsl::finally([env, pushedFrame]() {
+                    if (pushedFrame)
+                    {
+                        env->PopLocalFrame(nullptr);
+                    }
+                })};
+
+                // Tasks report their failures through their own continuations; anything escaping here would
+                // terminate the process, and a pending Java exception would poison the next job on this thread.
+                try
+                {
+                    work();
+                }
+                catch (...)
+                {
+                }
+
+                if (env->ExceptionCheck())
+                {
+                    env->ExceptionClear();
+                }
+
+                m_executed.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock{m_idleMutex};
+            m_idleCondition.wait(lock, [this]() { return m_stopping || m_pending.load(std::memory_order_relaxed) > 0; });
+            if (m_stopping && m_pending.load(std::memory_order_relaxed) == 0)
+            {
+                break;
+            }
+        }
+    }
+}
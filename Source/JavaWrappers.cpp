@@ -4,22 +4,132 @@
 #include <android/surface_texture_jni.h>
 #include <android/asset_manager_jni.h>
 #include <android/native_window_jni.h>
+#include <dlfcn.h>
+#include <gsl/gsl>
 #include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 using namespace android::global;
 
 namespace
 {
+    // The ASurfaceTexture functions were added in API level 28, so they are resolved at runtime rather than linked.
+    struct SurfaceTextureFunctions
+    {
+        ASurfaceTexture* (*FromSurfaceTexture)(JNIEnv*, jobject){};
+        void (*Release)(ASurfaceTexture*){};
+        int (*UpdateTexImage)(ASurfaceTexture*){};
+        int64_t (*GetTimestamp)(ASurfaceTexture*){};
+        void (*GetTransformMatrix)(ASurfaceTexture*, float[16]){};
+
+        explicit operator bool() const
+        {
+            return FromSurfaceTexture && Release && UpdateTexImage && GetTimestamp && GetTransformMatrix;
+        }
+    };
+
+    const SurfaceTextureFunctions& GetSurfaceTextureFunctions()
+    {
+        static const SurfaceTextureFunctions functions{[]()
+        {
+            SurfaceTextureFunctions functions{};
+
+            // libandroid is always loaded in an app process, so the handle is never closed.
+            if (void* library{dlopen("libandroid.so", RTLD_NOW | RTLD_LOCAL)})
+            {
+                functions.FromSurfaceTexture = reinterpret_cast<decltype(functions.FromSurfaceTexture)>(dlsym(library, "ASurfaceTexture_fromSurfaceTexture"));
+                functions.Release = reinterpret_cast<decltype(functions.Release)>(dlsym(library, "ASurfaceTexture_release"));
+                functions.UpdateTexImage = reinterpret_cast<decltype(functions.UpdateTexImage)>(dlsym(library, "ASurfaceTexture_updateTexImage"));
+                functions.GetTimestamp = reinterpret_cast<decltype(functions.GetTimestamp)>(dlsym(library, "ASurfaceTexture_getTimestamp"));
+                functions.GetTransformMatrix = reinterpret_cast<decltype(functions.GetTransformMatrix)>(dlsym(library, "ASurfaceTexture_getTransformMatrix"));
+            }
+
+            return functions;
+        }()};
+
+        return functions;
+    }
+
+    jclass FindGlobalClass(JNIEnv* env, const char* className)
+    {
+        jclass localClass{env->FindClass(className)};
+        auto globalClass{static_cast<jclass>(env->NewGlobalRef(localClass))};
+        env->DeleteLocalRef(localClass);
+        return globalClass;
+    }
+
+    jmethodID GetClassMethodID(JNIEnv* env, const char* className, const char* name, const char* signature)
+    {
+        jclass localClass{env->FindClass(className)};
+        jmethodID method{env->GetMethodID(localClass, name, signature)};
+        env->DeleteLocalRef(localClass);
+        return method;
+    }
+
+    template<typename ExceptionT>
+    [[noreturn]] void ThrowAs(JNIEnv* env, jthrowable throwable)
+    {
+        ExceptionT exception{throwable};
+        env->DeleteLocalRef(throwable);
+        throw exception;
+    }
+
     void ThrowIfFaulted(JNIEnv* env)
     {
         if (env->ExceptionCheck())
         {
             auto jthrowable{env->ExceptionOccurred()};
             env->ExceptionClear();
-            throw java::lang::Throwable{jthrowable};
+
+            // Map commonly handled Java exception types to their C++ counterparts. More derived types must be tested first.
+            static const struct ExceptionClasses final
+            {
+                jclass SocketTimeoutException;
+                jclass IOException;
+                jclass SecurityException;
+                jclass URISyntaxException;
+            } classes
+            {
+                FindGlobalClass(env, "java/net/SocketTimeoutException"),
+                FindGlobalClass(env, "java/io/IOException"),
+                FindGlobalClass(env, "java/lang/SecurityException"),
+                FindGlobalClass(env, "java/net/URISyntaxException"),
+            };
+
+            if (env->IsInstanceOf(jthrowable, classes.SocketTimeoutException))
+            {
+                ThrowAs<java::net::SocketTimeoutException>(env, jthrowable);
+            }
+            if (env->IsInstanceOf(jthrowable, classes.IOException))
+            {
+                ThrowAs<java::io::IOException>(env, jthrowable);
+            }
+            if (env->IsInstanceOf(jthrowable, classes.SecurityException))
+            {
+                ThrowAs<java::lang::SecurityException>(env, jthrowable);
+            }
+            if (env->IsInstanceOf(jthrowable, classes.URISyntaxException))
+            {
+                ThrowAs<java::net::URISyntaxException>(env, jthrowable);
+            }
+
+            ThrowAs<java::lang::Throwable>(env, jthrowable);
         }
     }
+
+    struct GetRequestMethod
+    {
+        static constexpr const char* Value{"GET"};
+    };
+
+    struct PostRequestMethod
+    {
+        static constexpr const char* Value{"POST"};
+    };
 }
 
 namespace java::lang
@@ -260,26 +370,129 @@ namespace java::lang
         return str;
     }
 
+    jstring InternString(const char* string)
+    {
+        static std::mutex mutex{};
+        static std::unordered_map<std::string, jstring> strings{};
+
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it{strings.find(string)};
+        if (it == strings.end())
+        {
+            JNIEnv* env{GetEnvForCurrentThread()};
+            jstring localString{env->NewStringUTF(string)};
+            ThrowIfFaulted(env);
+            it = strings.emplace(string, static_cast<jstring>(env->NewGlobalRef(localString))).first;
+            env->DeleteLocalRef(localString);
+        }
+
+        return it->second;
+    }
+
+    struct Throwable::Details final
+    {
+        Details(jthrowable throwable)
+            : m_throwable{static_cast<jthrowable>(GetEnvForCurrentThread()->NewGlobalRef(throwable))}
+        {
+        }
+
+        ~Details()
+        {
+            GetEnvForCurrentThread()->DeleteGlobalRef(m_throwable);
+        }
+
+        void Resolve()
+        {
+            std::call_once(m_resolved, [this]()
+            {
+                JNIEnv* env{GetEnvForCurrentThread()};
+
+                // what() may be called while a Java exception is still pending, and no JNI calls can be made until
+                // it is cleared, so it is set aside and thrown again afterwards.
+                jthrowable pending{env->ExceptionOccurred()};
+                if (pending)
+                {
+                    env->ExceptionClear();
+                }
+
+                auto restorePending{gsl::finally([env, pending]() {
+                    if (pending)
+                    {
+                        env->Throw(pending);
+                        env->DeleteLocalRef(pending);
+                    }
+                })};
+
+                static const jmethodID getMessage{GetClassMethodID(env, "java/lang/Throwable", "getMessage", "()Ljava/lang/String;")};
+                static const jmethodID getName{GetClassMethodID(env, "java/lang/Class", "getName", "()Ljava/lang/String;")};
+
+                // Nothing useful can be reported if the accessors themselves fail.
+                jclass throwableClass{env->GetObjectClass(m_throwable)};
+                auto className{static_cast<jstring>(env->CallObjectMethod(throwableClass, getName))};
+                if (env->ExceptionCheck())
+                {
+                    env->ExceptionClear();
+                    env->DeleteLocalRef(throwableClass);
+                    return;
+                }
+
+                auto message{static_cast<jstring>(env->CallObjectMethod(m_throwable, getMessage))};
+                if (env->ExceptionCheck())
+                {
+                    env->ExceptionClear();
+                }
+                else
+                {
+                    m_className = className ? String{className} : std::string{};
+                    m_message = message ? String{message} : m_className;
+                }
+
+                env->DeleteLocalRef(message);
+                env->DeleteLocalRef(className);
+                env->DeleteLocalRef(throwableClass);
+            });
+        }
+
+        const jthrowable m_throwable;
+        std::once_flag m_resolved{};
+        std::string m_className{};
+        std::string m_message{};
+    };
+
     Throwable::Throwable(jthrowable throwable)
-        : Object{throwable}
-        , m_throwableRef{m_env->NewGlobalRef(throwable)}
-        , m_message{GetMessage()}
+        : m_details{std::make_shared<Details>(throwable)}
     {
     }
 
-    Throwable::~Throwable()
+    Throwable::operator jthrowable() const
     {
-        m_env->DeleteGlobalRef(m_throwableRef);
+        return m_details->m_throwable;
     }
 
     String Throwable::GetMessage() const
     {
-        return {(jstring)m_env->CallObjectMethod(JObject(), m_env->GetMethodID(m_class, "getMessage", "()Ljava/lang/String;"))};
+        JNIEnv* env{GetEnvForCurrentThread()};
+        static const jmethodID getMessage{GetClassMethodID(env, "java/lang/Throwable", "getMessage", "()Ljava/lang/String;")};
+        return {(jstring)env->CallObjectMethod(m_details->m_throwable, getMessage)};
+    }
+
+    std::string Throwable::GetClassName() const
+    {
+        m_details->Resolve();
+        return m_details->m_className;
     }
 
     const char* Throwable::what() const noexcept
     {
-        return m_message.c_str();
+        try
+        {
+            m_details->Resolve();
+            return m_details->m_message.c_str();
+        }
+        catch (...)
+        {
+            return "Java exception";
+        }
     }
 }
 
@@ -443,7 +656,7 @@ namespace java::io
     lang::String ByteArrayOutputStream::ToString(const char* charsetName) const
     {
         jmethodID method{m_env->GetMethodID(m_class, "toString", "(Ljava/lang/String;)Ljava/lang/String;")};
-        return {(jstring)m_env->CallObjectMethod(JObject(), method, m_env->NewStringUTF(charsetName))};
+        return {(jstring)m_env->CallObjectMethod(JObject(), method, lang::InternString(charsetName))};
     }
 
     InputStream::InputStream(jobject object)
@@ -507,7 +720,7 @@ namespace java::net
         {
             throw std::runtime_error("Only POST and GET are supported as arguments to setRequestMethod.");
         }
-        jstring requestMethodJstr = m_env->NewStringUTF(requestMethod.c_str());
+        jstring requestMethodJstr = requestMethod == "POST" ? lang::InternedString<PostRequestMethod>() : lang::InternedString<GetRequestMethod>();
         m_env->CallVoidMethod(JObject(), m_env->GetMethodID(m_class, "setRequestMethod", "(Ljava/lang/String;)V"), requestMethodJstr);
         ThrowIfFaulted(m_env);
     }
@@ -620,17 +833,67 @@ namespace java::net
 
 namespace android
 {
+    namespace
+    {
+        // Fields of android.Manifest.permission, indexed by ManifestPermission::Permission.
+        constexpr std::array<const char*, 6> PERMISSION_FIELD_NAMES
+        {
+            "CAMERA",
+            "RECORD_AUDIO",
+            "READ_EXTERNAL_STORAGE",
+            "WRITE_EXTERNAL_STORAGE",
+            "ACCESS_COARSE_LOCATION",
+            "ACCESS_FINE_LOCATION",
+        };
+    }
+
     jstring ManifestPermission::CAMERA()
     {
-        return getPermissionName("CAMERA");
+        return Get(Permission::Camera);
+    }
+
+    jstring ManifestPermission::Get(Permission permission)
+    {
+        static const auto permissions{[]()
+        {
+            std::array<jstring, PERMISSION_FIELD_NAMES.size()> permissions{};
+            for (size_t index = 0; index < permissions.size(); ++index)
+            {
+                permissions[index] = getPermissionName(PERMISSION_FIELD_NAMES[index]);
+            }
+            return permissions;
+        }()};
+
+        return permissions[static_cast<size_t>(permission)];
+    }
+
+    const std::string& ManifestPermission::GetName(Permission permission)
+    {
+        static const auto names{[]()
+        {
+            std::array<std::string, PERMISSION_FIELD_NAMES.size()> names{};
+            for (size_t index = 0; index < names.size(); ++index)
+            {
+                names[index] = java::lang::String{Get(static_cast<Permission>(index))};
+            }
+            return names;
+        }()};
+
+        return names[static_cast<size_t>(permission)];
     }
 
     jstring ManifestPermission::getPermissionName(const char* permissionName)
     {
+        // The returned reference is global so that callers can cache it across calls and threads.
         JNIEnv* env{GetEnvForCurrentThread()};
         jclass cls{env->FindClass("android/Manifest$permission")};
         jfieldID permId{env->GetStaticFieldID(cls, permissionName, "Ljava/lang/String;")};
-        return (jstring)env->GetStaticObjectField(cls, permId);
+        jobject localPermission{env->GetStaticObjectField(cls, permId)};
+        ThrowIfFaulted(env);
+        auto permission{static_cast<jstring>(env->NewGlobalRef(localPermission))};
+        env->DeleteLocalRef(localPermission);
+        env->DeleteLocalRef(cls);
+        return permission;
     }
 }
 
@@ -650,6 +913,22 @@ namespace android::app
         m_env->CallVoidMethod(JObject(), m_env->GetMethodID(m_class, "requestPermissions", "([Ljava/lang/String;I)V"), permissionArray, permissionRequestID);
         m_env->DeleteLocalRef(permissionArray);
     }
+
+    void Activity::requestPermissions(const std::vector<std::string>& systemPermissionNames, int permissionRequestID)
+    {
+        jclass stringClass{m_env->FindClass("java/lang/String")};
+        jobjectArray permissionArray{m_env->NewObjectArray(static_cast<jsize>(systemPermissionNames.size()), stringClass, nullptr)};
+        for (size_t index = 0; index < systemPermissionNames.size(); ++index)
+        {
+            // Permission names are constants, so they are interned rather than allocated per request.
+            m_env->SetObjectArrayElement(permissionArray, static_cast<jsize>(index), java::lang::InternString(systemPermissionNames[index].c_str()));
+        }
+
+        m_env->CallVoidMethod(JObject(), m_env->GetMethodID(m_class, "requestPermissions", "([Ljava/lang/String;I)V"), permissionArray, permissionRequestID);
+        m_env->DeleteLocalRef(permissionArray);
+        m_env->DeleteLocalRef(stringClass);
+        ThrowIfFaulted(m_env);
+    }
 }
 
 namespace android::content
@@ -669,9 +948,19 @@ namespace android::content
         return {m_env->CallObjectMethod(JObject(), m_env->GetMethodID(m_class, "getAssets", "()Landroid/content/res/AssetManager;"))};
     }
 
+    ContentResolver Context::getContentResolver() const
+    {
+        return {m_env->CallObjectMethod(JObject(), m_env->GetMethodID(m_class, "getContentResolver", "()Landroid/content/ContentResolver;"))};
+    }
+
     jobject Context::getSystemService(const char* serviceName)
     {
-        return m_env->CallObjectMethod(JObject(), m_env->GetMethodID(m_class, "getSystemService", "(Ljava/lang/String;)Ljava/lang/Object;"), m_env->NewStringUTF(serviceName));
+        return getSystemService(java::lang::InternString(serviceName));
+    }
+
+    jobject Context::getSystemService(jstring serviceName)
+    {
+        return m_env->CallObjectMethod(JObject(), m_env->GetMethodID(m_class, "getSystemService", "(Ljava/lang/String;)Ljava/lang/Object;"), serviceName);
     }
 
     res::Resources Context::getResources() {
@@ -680,16 +969,83 @@ namespace android::content
 
     bool Context::checkSelfPermission(jstring systemPermissionName)
     {
-        // Get the package manager, and get the value that represents a successful permission grant.
-        jclass packageManager{m_env->FindClass("android/content/pm/PackageManager")};
-        jfieldID permissionGrantedId{m_env->GetStaticFieldID(packageManager, "PERMISSION_GRANTED", "I")};
-        jint permissionGrantedValue{m_env->GetStaticIntField(packageManager, permissionGrantedId)};
+        // Get the package manager, and get the value that represents a successful permission grant. Neither the
+        // constant nor the method can change while the process is running, so they are only looked up once.
+        static const jint permissionGrantedValue{[env{m_env}]()
+        {
+            jclass packageManager{env->FindClass("android/content/pm/PackageManager")};
+            jint value{env->GetStaticIntField(packageManager, env->GetStaticFieldID(packageManager, "PERMISSION_GRANTED", "I"))};
+            env->DeleteLocalRef(packageManager);
+            return value;
+        }()};
+        static const jmethodID checkSelfPermissionMethod{[env{m_env}]()
+        {
+            jclass context{env->FindClass("android/content/Context")};
+            jmethodID method{env->GetMethodID(context, "checkSelfPermission", "(Ljava/lang/String;)I")};
+            env->DeleteLocalRef(context);
+            return method;
+        }()};
 
         // Perform the actual permission check by checking against the android context object.
-        jint permissionCheckResult{m_env->CallIntMethod(JObject(), m_env->GetMethodID(m_class, "checkSelfPermission", "(Ljava/lang/String;)I"), systemPermissionName)};
+        jint permissionCheckResult{m_env->CallIntMethod(JObject(), checkSelfPermissionMethod, systemPermissionName)};
         ThrowIfFaulted(m_env);
         return permissionGrantedValue == permissionCheckResult;
     }
+
+    bool Context::checkSelfPermission(ManifestPermission::Permission permission)
+    {
+        return checkSelfPermission(ManifestPermission::Get(permission));
+    }
+
+    std::vector<bool> Context::checkSelfPermission(const std::vector<ManifestPermission::Permission>& permissions)
+    {
+        std::vector<bool> results{};
+        results.reserve(permissions.size());
+        for (auto permission : permissions)
+        {
+            results.push_back(checkSelfPermission(ManifestPermission::Get(permission)));
+        }
+        return results;
+    }
+}
+
+namespace android::content
+{
+    ContentResolver::ContentResolver(jobject object)
+        : Object{object}
+    {
+    }
+
+    os::ParcelFileDescriptor ContentResolver::openFileDescriptor(const net::Uri& uri, const char* mode) const
+    {
+        jstring modeJstr{m_env->NewStringUTF(mode)};
+        auto parcelFileDescriptor{m_env->CallObjectMethod(JObject(), m_env->GetMethodID(m_class, "openFileDescriptor", "(Landroid/net/Uri;Ljava/lang/String;)Landroid/os/ParcelFileDescriptor;"), (jobject)uri, modeJstr)};
+        m_env->DeleteLocalRef(modeJstr);
+        ThrowIfFaulted(m_env);
+
+        // Providers return null rather than throwing when they have no file to hand out.
+        if (!parcelFileDescriptor)
+        {
+            throw std::runtime_error{"No file descriptor available for " + std::string{uri.toString()}};
+        }
+
+        return {parcelFileDescriptor};
+    }
+}
+
+namespace android::os
+{
+    ParcelFileDescriptor::ParcelFileDescriptor(jobject object)
+        : Object{object}
+    {
+    }
+
+    int ParcelFileDescriptor::detachFd()
+    {
+        auto fd{m_env->CallIntMethod(JObject(), m_env->GetMethodID(m_class, "detachFd", "()I"))};
+        ThrowIfFaulted(m_env);
+        return fd;
+    }
 }
 
 namespace android::content::res
@@ -704,6 +1060,31 @@ namespace android::content::res
         return AAssetManager_fromJava(m_env, JObject());
     }
 
+    std::vector<std::string> AssetManager::list(const char* path) const
+    {
+        jstring pathJstr{m_env->NewStringUTF(path)};
+        auto names{(jobjectArray)m_env->CallObjectMethod(JObject(), m_env->GetMethodID(m_class, "list", "(Ljava/lang/String;)[Ljava/lang/String;"), pathJstr)};
+        m_env->DeleteLocalRef(pathJstr);
+        ThrowIfFaulted(m_env);
+
+        std::vector<std::string> result{};
+        if (names)
+        {
+            const jsize length{m_env->GetArrayLength(names)};
+            result.reserve(static_cast<size_t>(length));
+            for (jsize index = 0; index < length; ++index)
+            {
+                auto name{(jstring)m_env->GetObjectArrayElement(names, index)};
+                result.push_back(java::lang::String{name});
+                m_env->DeleteLocalRef(name);
+            }
+
+            m_env->DeleteLocalRef(names);
+        }
+
+        return result;
+    }
+
     Configuration::Configuration(jobject object)
         : Object(object)
     {
@@ -775,6 +1156,13 @@ namespace android::net
         return {path};
     }
 
+    java::lang::String Uri::toString() const
+    {
+        auto string{(jstring)m_env->CallObjectMethod(JObject(), m_env->GetMethodID(m_class, "toString", "()Ljava/lang/String;"))};
+        ThrowIfFaulted(m_env);
+        return {string};
+    }
+
     Uri Uri::Parse(java::lang::String uriString)
     {
         JNIEnv* env{GetEnvForCurrentThread()};
@@ -787,6 +1175,38 @@ namespace android::net
 
 namespace android::graphics
 {
+    // Frame callbacks arrive on the listener thread, so the state is found by id under a registry lock that also keeps
+    // it alive while the callback updates it.
+    struct SurfaceTexture::FrameState final
+    {
+        FrameState()
+        {
+            std::lock_guard<std::mutex> guard{RegistryMutex};
+            Id = ++NextId;
+            Registry.emplace(Id, this);
+        }
+
+        ~FrameState()
+        {
+            std::lock_guard<std::mutex> guard{RegistryMutex};
+            Registry.erase(Id);
+        }
+
+        static inline std::mutex RegistryMutex{};
+        static inline std::unordered_map<jlong, FrameState*> Registry{};
+        static inline jlong NextId{};
+
+        jlong Id{};
+        std::mutex Mutex{};
+        std::condition_variable Condition{};
+        uint64_t Available{};
+        uint64_t Latched{};
+        uint64_t Dropped{};
+        uint64_t Duplicated{};
+    };
+
+    jclass SurfaceTexture::s_listenerClass{};
+
     SurfaceTexture::SurfaceTexture()
         : Object("android/graphics/SurfaceTexture")
     {
@@ -794,13 +1214,73 @@ namespace android::graphics
 
     void SurfaceTexture::InitWithTexture(int texture)
     {
+        // Released before the Java object they belong to is replaced.
+        m_surfaceTexture.reset();
+        m_frameState.reset();
+
         JObject(m_env->NewObject(m_class, m_env->GetMethodID(m_class, "<init>", "(I)V"), texture));
+
+        const auto& functions{GetSurfaceTextureFunctions()};
+        if (functions)
+        {
+            // The Java object must outlive the native handle, which is shared by copies of this wrapper and may
+            // outlive this one, so the deleter holds its own global reference to it.
+            if (ASurfaceTexture* surfaceTexture{functions.FromSurfaceTexture(m_env, JObject())})
+            {
+                jobject surfaceTextureObject{m_env->NewGlobalRef(JObject())};
+                m_surfaceTexture = {surfaceTexture, [surfaceTextureObject](ASurfaceTexture* surfaceTexture) {
+                    GetSurfaceTextureFunctions().Release(surfaceTexture);
+                    GetEnvForCurrentThread()->DeleteGlobalRef(surfaceTextureObject);
+                }};
+            }
+        }
+
+        if (s_listenerClass)
+        {
+            auto frameState{std::make_shared<FrameState>()};
+
+            // The SurfaceTexture holds on to the listener, so no reference to it is kept here.
+            jobject listener{m_env->NewObject(s_listenerClass, m_env->GetMethodID(s_listenerClass, "<init>", "(Landroid/graphics/SurfaceTexture;J)V"), JObject(), frameState->Id)};
+            ThrowIfFaulted(m_env);
+            m_env->DeleteLocalRef(listener);
+
+            m_frameState = std::move(frameState);
+        }
     }
 
     void SurfaceTexture::updateTexImage() const
     {
-        if (JObject()) {
-            m_env->CallVoidMethod(JObject(), m_env->GetMethodID(m_class, "updateTexImage", "()V"));
+        if (m_frameState)
+        {
+            // Counted before latching, so a frame queued during the update is only seen as new on the next call.
+            std::lock_guard<std::mutex> guard{m_frameState->Mutex};
+            const uint64_t pending{m_frameState->Available - m_frameState->Latched};
+            if (pending == 0)
+            {
+                ++m_frameState->Duplicated;
+            }
+            else
+            {
+                m_frameState->Dropped += pending - 1;
+            }
+
+            m_frameState->Latched = m_frameState->Available;
+        }
+
+        if (m_surfaceTexture)
+        {
+            // Fails the same way as the JNI path, where the error arrives as a Java exception.
+            const int status{GetSurfaceTextureFunctions().UpdateTexImage(m_surfaceTexture.get())};
+            if (status != 0)
+            {
+                throw std::runtime_error{"Failed to update the SurfaceTexture image: " + std::to_string(status)};
+            }
+        }
+        else if (JObject())
+        {
+            static const jmethodID updateTexImage{m_env->GetMethodID(m_class, "updateTexImage", "()V")};
+            m_env->CallVoidMethod(JObject(), updateTexImage);
+            ThrowIfFaulted(m_env);
         }
     }
 
@@ -811,4 +1291,116 @@ namespace android::graphics
         }
     }
 
+    int64_t SurfaceTexture::getTimestamp() const
+    {
+        if (m_surfaceTexture)
+        {
+            return GetSurfaceTextureFunctions().GetTimestamp(m_surfaceTexture.get());
+        }
+
+        if (JObject())
+        {
+            static const jmethodID getTimestamp{m_env->GetMethodID(m_class, "getTimestamp", "()J")};
+            const jlong timestamp{m_env->CallLongMethod(JObject(), getTimestamp)};
+            ThrowIfFaulted(m_env);
+            return timestamp;
+        }
+
+        return 0;
+    }
+
+    void SurfaceTexture::getTransformMatrix(float matrix[16]) const
+    {
+        if (m_surfaceTexture)
+        {
+            GetSurfaceTextureFunctions().GetTransformMatrix(m_surfaceTexture.get(), matrix);
+        }
+        else if (JObject())
+        {
+            static const jmethodID getTransformMatrix{m_env->GetMethodID(m_class, "getTransformMatrix", "([F)V")};
+            jfloatArray array{m_env->NewFloatArray(16)};
+            if (!array)
+            {
+                // The allocation failure is normally pending as an OutOfMemoryError.
+                ThrowIfFaulted(m_env);
+                throw std::runtime_error{"Failed to allocate the SurfaceTexture transform matrix"};
+            }
+
+            auto deleteArray{gsl::finally([this, array]() { m_env->DeleteLocalRef(array); })};
+            m_env->CallVoidMethod(JObject(), getTransformMatrix, array);
+            ThrowIfFaulted(m_env);
+            m_env->GetFloatArrayRegion(array, 0, 16, matrix);
+        }
+    }
+
+    bool SurfaceTexture::hasNewFrame() const
+    {
+        if (!m_frameState)
+        {
+            return true;
+        }
+
+        std::lock_guard<std::mutex> guard{m_frameState->Mutex};
+        return m_frameState->Available != m_frameState->Latched;
+    }
+
+    bool SurfaceTexture::waitForFrame(std::chrono::milliseconds timeout) const
+    {
+        if (!m_frameState)
+        {
+            return true;
+        }
+
+        std::unique_lock<std::mutex> lock{m_frameState->Mutex};
+        return m_frameState->Condition.wait_for(lock, timeout, [frameState{m_frameState.get()}]() {
+            return frameState->Available != frameState->Latched;
+        });
+    }
+
+    SurfaceTexture::FrameStatistics SurfaceTexture::getFrameStatistics() const
+    {
+        if (!m_frameState)
+        {
+            return {};
+        }
+
+        std::lock_guard<std::mutex> guard{m_frameState->Mutex};
+        return {m_frameState->Available, m_frameState->Dropped, m_frameState->Duplicated};
+    }
+
+    void SurfaceTexture::OnFrameAvailable(JNIEnv*, jclass, jlong id)
+    {
+        std::lock_guard<std::mutex> registryGuard{FrameState::RegistryMutex};
+        const auto it{FrameState::Registry.find(id)};
+        if (it == FrameState::Registry.end())
+        {
+            return;
+        }
+
+        FrameState& frameState{*it->second};
+        {
+            std::lock_guard<std::mutex> guard{frameState.Mutex};
+            ++frameState.Available;
+        }
+
+        frameState.Condition.notify_all();
+    }
+
+    void SurfaceTexture::InitializeJavaSurfaceTextureListenerClass(jclass listenerClass, JNIEnv* env)
+    {
+        s_listenerClass = (jclass) env->NewGlobalRef(listenerClass);
+
+        static JNINativeMethod methods[] =
+        {
+            {"frameAvailableCallback", "(J)V", (void*)OnFrameAvailable},
+        };
+        env->RegisterNatives(s_listenerClass, methods, 1);
+    }
+
+    void SurfaceTexture::DestructJavaSurfaceTextureListenerClass(JNIEnv* env)
+    {
+        env->DeleteGlobalRef(s_listenerClass);
+        s_listenerClass = nullptr;
+    }
+
 }
\ No newline at end of file
@@ -0,0 +1,206 @@
+#include <AndroidExtensions/MemoryPressure.h>
+#include <algorithm>
+#include <condition_variable>
+#include <gsl/gsl>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+namespace android::MemoryPressure
+{
+    namespace
+    {
+        struct Cache final
+        {
+            Cache(std::string name, int32_t priority, CacheSizeCallback&& getSize, CacheTrimCallback&& trim)
+                : Name{std::move(name)}
+                , Priority{priority}
+                , GetSize{std::move(getSize)}
+                , Trim{std::move(trim)}
+            {
+            }
+
+            const std::string Name;
+            const int32_t Priority;
+            const CacheSizeCallback GetSize;
+            const CacheTrimCallback Trim;
+
+            std::mutex Mutex{};
+            std::condition_variable Idle{};
+            bool Active{true};
+            size_t InFlight{};
+        };
+
+        std::mutex g_mutex{};
+
+        // Kept sorted by ascending priority, in registration order within a priority.
+        std::vector<std::shared_ptr<Cache>> g_caches{};
+
+        // Registered lazily so that apps which never register a cache do not pay for the subscription. The ticket
+        // lives for the rest of the process and is deliberately never destroyed, since the event it unregisters from
+        // is a static in another translation unit and may already be gone during static destruction.
+        global::TrimMemoryCallbackTicket* g_trimMemoryTicket{};
+
+        // Caches whose callbacks are running on this thread, innermost last.
+        thread_local std::vector<const Cache*> t_runningCaches{};
+
+        std::vector<std::shared_ptr<Cache>> GetActiveCaches()
+        {
+            std::lock_guard<std::mutex> guard{g_mutex};
+            return g_caches;
+        }
+
+        // Runs one of the cache's callbacks, or returns nothing if the cache has been unregistered. The call is
+        // counted while it runs so that releasing the ticket can wait for it.
+        template<typename Callback>
+        std::optional<size_t> Invoke(Cache& cache, Callback&& callback)
+        {
+            {
+                std::lock_guard<std::mutex> guard{cache.Mutex};
+                if (!cache.Active)
+                {
+                    return {};
+                }
+
+                ++cache.InFlight;
+            }
+
+            t_runningCaches.push_back(&cache);
+            auto finished{gsl::finally([&cache]() {
+                t_runningCaches.pop_back();
+                {
+                    std::lock_guard<std::mutex> guard{cache.Mutex};
+                    --cache.InFlight;
+                }
+
+                cache.Idle.notify_all();
+            })};
+
+            return callback();
+        }
+
+        // Fraction of the cached bytes to release for a given trim level, in percent.
+        size_t GetTrimPercentage(int32_t level)
+        {
+            if (level >= static_cast<int32_t>(TrimLevel::Moderate))
+            {
+                return 100;
+            }
+
+            if (level >= static_cast<int32_t>(TrimLevel::Background))
+            {
+                return 75;
+            }
+
+            if (level >= static_cast<int32_t>(TrimLevel::UiHidden))
+            {
+                return 50;
+            }
+
+            if (level >= static_cast<int32_t>(TrimLevel::RunningCritical))
+            {
+                return 100;
+            }
+
+            if (level >= static_cast<int32_t>(TrimLevel::RunningLow))
+            {
+                return 50;
+            }
+
+            return 25;
+        }
+    }
+
+    CacheTicket RegisterCache(std::string name, int32_t priority, CacheSizeCallback&& getSize, CacheTrimCallback&& trim)
+    {
+        auto cache{std::make_shared<Cache>(std::move(name), priority, std::move(getSize), std::move(trim))};
+
+        {
+            std::lock_guard<std::mutex> guard{g_mutex};
+
+            auto position{std::upper_bound(g_caches.begin(), g_caches.end(), priority, [](int32_t priority, const auto& cache) {
+                return priority < cache->Priority;
+            })};
+            g_caches.insert(position, cache);
+
+            if (!g_trimMemoryTicket)
+            {
+                g_trimMemoryTicket = new global::TrimMemoryCallbackTicket{global::AddTrimMemoryCallback([](int32_t level) {
+                    Trim(static_cast<TrimLevel>(level));
+                })};
+            }
+        }
+
+        return CacheTicket{[cache]() {
+            // Callbacks already running on other threads are waited for, so the cache is never touched once its
+            // ticket has been released. A callback that releases its own ticket cannot wait for itself.
+            {
+                std::unique_lock<std::mutex> lock{cache->Mutex};
+                cache->Active = false;
+
+                const auto ownCalls{static_cast<size_t>(std::count(t_runningCaches.begin(), t_runningCaches.end(), cache.get()))};
+                cache->Idle.wait(lock, [&cache, ownCalls]() { return cache->InFlight == ownCalls; });
+            }
+
+            std::lock_guard<std::mutex> guard{g_mutex};
+            g_caches.erase(std::remove(g_caches.begin(), g_caches.end(), cache), g_caches.end());
+        }};
+    }
+
+    size_t GetTotalCachedBytes()
+    {
+        size_t total{};
+        for (const auto& cache : GetActiveCaches())
+        {
+            total += Invoke(*cache, [&cache]() { return cache->GetSize(); }).value_or(0);
+        }
+
+        return total;
+    }
+
+    std::vector<CacheInfo> GetCaches()
+    {
+        std::vector<CacheInfo> result{};
+        for (const auto& cache : GetActiveCaches())
+        {
+            if (const auto size{Invoke(*cache, [&cache]() { return cache->GetSize(); })})
+            {
+                result.push_back({cache->Name, cache->Priority, *size});
+            }
+        }
+
+        return result;
+    }
+
+    size_t Trim(size_t bytesToRelease)
+    {
+        // The callbacks are invoked without holding the registry lock, since trimming can take a while
+        // and caches may register or unregister other caches while doing so.
+        size_t released{};
+        for (const auto& cache : GetActiveCaches())
+        {
+            if (released >= bytesToRelease)
+            {
+                break;
+            }
+
+            released += Invoke(*cache, [&cache, remaining{bytesToRelease - released}]() {
+                return cache->Trim(remaining);
+            }).value_or(0);
+        }
+
+        return released;
+    }
+
+    size_t Trim(TrimLevel level)
+    {
+        const size_t percentage{GetTrimPercentage(static_cast<int32_t>(level))};
+        if (percentage == 100)
+        {
+            return Trim(std::numeric_limits<size_t>::max());
+        }
+
+        return Trim(GetTotalCachedBytes() * percentage / 100);
+    }
+}
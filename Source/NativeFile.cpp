@@ -0,0 +1,249 @@
+#include <AndroidExtensions/NativeFile.h>
+#include <AndroidExtensions/Globals.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace android
+{
+    namespace
+    {
+        [[noreturn]] void ThrowErrno(const std::string& message)
+        {
+            throw std::runtime_error{message + ": " + std::strerror(errno)};
+        }
+
+        int GetAdvice(ReadPattern pattern)
+        {
+            switch (pattern)
+            {
+                case ReadPattern::Sequential:
+                    return POSIX_FADV_SEQUENTIAL;
+                case ReadPattern::Random:
+                    return POSIX_FADV_RANDOM;
+                default:
+                    return POSIX_FADV_NORMAL;
+            }
+        }
+
+        int GetMemoryAdvice(ReadPattern pattern)
+        {
+            switch (pattern)
+            {
+                case ReadPattern::Sequential:
+                    return MADV_SEQUENTIAL;
+                case ReadPattern::Random:
+                    return MADV_RANDOM;
+                default:
+                    return MADV_NORMAL;
+            }
+        }
+    }
+
+    NativeFile::Mapping::Mapping(const NativeFile& file, uint64_t offset, size_t length, ReadPattern pattern)
+        : m_size{length}
+    {
+        if (m_size == 0)
+        {
+            return;
+        }
+
+        // Mappings have to start on a page boundary.
+        const uint64_t pageSize{static_cast<uint64_t>(sysconf(_SC_PAGESIZE))};
+        const uint64_t alignedOffset{offset - offset % pageSize};
+        const size_t padding{static_cast<size_t>(offset - alignedOffset)};
+
+        void* mapping{mmap64(nullptr, padding + m_size, PROT_READ, MAP_PRIVATE, file.Descriptor(), static_cast<off64_t>(alignedOffset))};
+        if (mapping == MAP_FAILED)
+        {
+            ThrowErrno("Failed to map file");
+        }
+
+        m_mapping = mapping;
+        m_mappingSize = padding + m_size;
+        m_data = static_cast<const std::byte*>(mapping) + padding;
+        madvise(m_mapping, m_mappingSize, GetMemoryAdvice(pattern));
+    }
+
+    NativeFile::Mapping::~Mapping()
+    {
+        if (m_mapping)
+        {
+            munmap(m_mapping, m_mappingSize);
+        }
+    }
+
+    NativeFile::Mapping::Mapping(Mapping&& other) noexcept
+        : m_mapping{std::exchange(other.m_mapping, nullptr)}
+        , m_mappingSize{std::exchange(other.m_mappingSize, 0)}
+        , m_data{std::exchange(other.m_data, nullptr)}
+        , m_size{std::exchange(other.m_size, 0)}
+    {
+    }
+
+    NativeFile::Mapping& NativeFile::Mapping::operator=(Mapping&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_mapping)
+            {
+                munmap(m_mapping, m_mappingSize);
+            }
+
+            m_mapping = std::exchange(other.m_mapping, nullptr);
+            m_mappingSize = std::exchange(other.m_mappingSize, 0);
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+        }
+
+        return *this;
+    }
+
+    gsl::span<const std::byte> NativeFile::Mapping::Data() const
+    {
+        return m_data ? gsl::span<const std::byte>{m_data, m_size} : gsl::span<const std::byte>{};
+    }
+
+    NativeFile NativeFile::Open(const net::Uri& uri)
+    {
+        const std::string scheme{uri.getScheme()};
+        if (scheme == "file")
+        {
+            const std::string path{uri.getPath()};
+            int fd{open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+            if (fd < 0)
+            {
+                ThrowErrno("Failed to open " + path);
+            }
+
+            return NativeFile{fd};
+        }
+
+        if (scheme == "content")
+        {
+            return NativeFile{global::GetAppContext().getContentResolver().openFileDescriptor(uri, "r").detachFd()};
+        }
+
+        throw std::runtime_error{"Unsupported Uri scheme: " + scheme};
+    }
+
+    NativeFile NativeFile::Open(const net::ParsedUri& uri)
+    {
+        if (uri.Scheme() == "file")
+        {
+            const std::string path{uri.DecodedPath()};
+            int fd{open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+            if (fd < 0)
+            {
+                ThrowErrno("Failed to open " + path);
+            }
+
+            return NativeFile{fd};
+        }
+
+        return Open(uri.ToUri());
+    }
+
+    NativeFile::NativeFile(int fd)
+        : m_fd{fd}
+    {
+    }
+
+    NativeFile::~NativeFile()
+    {
+        if (m_fd >= 0)
+        {
+            close(m_fd);
+        }
+    }
+
+    NativeFile::NativeFile(NativeFile&& other) noexcept
+        : m_fd{std::exchange(other.m_fd, -1)}
+    {
+    }
+
+    NativeFile& NativeFile::operator=(NativeFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_fd >= 0)
+            {
+                close(m_fd);
+            }
+
+            m_fd = std::exchange(other.m_fd, -1);
+        }
+
+        return *this;
+    }
+
+    int NativeFile::Descriptor() const
+    {
+        return m_fd;
+    }
+
+    uint64_t NativeFile::Size() const
+    {
+        struct stat status{};
+        if (fstat(m_fd, &status) != 0)
+        {
+            ThrowErrno("Failed to query file size");
+        }
+
+        return S_ISREG(status.st_mode) ? static_cast<uint64_t>(status.st_size) : 0;
+    }
+
+    size_t NativeFile::Read(uint64_t offset, gsl::span<std::byte> buffer) const
+    {
+        size_t total{};
+        while (total < buffer.size())
+        {
+            ssize_t count{pread64(m_fd, buffer.data() + total, buffer.size() - total, static_cast<off64_t>(offset + total))};
+            if (count < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                ThrowErrno("Failed to read file");
+            }
+
+            if (count == 0)
+            {
+                break;
+            }
+
+            total += static_cast<size_t>(count);
+        }
+
+        return total;
+    }
+
+    NativeFile::Mapping NativeFile::Map(uint64_t offset, size_t length, ReadPattern pattern) const
+    {
+        if (length == 0)
+        {
+            const uint64_t size{Size()};
+            length = offset < size ? static_cast<size_t>(size - offset) : 0;
+        }
+
+        return {*this, offset, length, pattern};
+    }
+
+    void NativeFile::Advise(ReadPattern pattern, uint64_t offset, uint64_t length) const
+    {
+        posix_fadvise64(m_fd, static_cast<off64_t>(offset), static_cast<off64_t>(length), GetAdvice(pattern));
+    }
+
+    void NativeFile::Prefetch(uint64_t offset, uint64_t length) const
+    {
+        posix_fadvise64(m_fd, static_cast<off64_t>(offset), static_cast<off64_t>(length), POSIX_FADV_WILLNEED);
+    }
+}
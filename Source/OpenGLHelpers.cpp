@@ -35,11 +35,8 @@ namespace android::OpenGLHelpers
         return shader;
     }
 
-    GLuint CreateShaderProgram(const char* vertShaderSource, const char* fragShaderSource)
+    GLuint LinkShaderProgram(GLuint vertShader, GLuint fragShader, bool binaryRetrievable)
     {
-        GLuint vertShader{ LoadShader(GL_VERTEX_SHADER, vertShaderSource) };
-        GLuint fragShader{ LoadShader(GL_FRAGMENT_SHADER, fragShaderSource) };
-
         GLuint program{ glCreateProgram() };
         if (!program)
         {
@@ -49,14 +46,17 @@ namespace android::OpenGLHelpers
         glAttachShader(program, vertShader);
         glAttachShader(program, fragShader);
 
+        if (binaryRetrievable)
+        {
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+
         glLinkProgram(program);
         GLint linkStatus{ GL_FALSE };
         glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
 
         glDetachShader(program, vertShader);
-        glDeleteShader(vertShader);
         glDetachShader(program, fragShader);
-        glDeleteShader(fragShader);
 
         if (linkStatus != GL_TRUE)
         {
@@ -76,4 +76,17 @@ namespace android::OpenGLHelpers
 
         return program;
     }
+
+    GLuint CreateShaderProgram(const char* vertShaderSource, const char* fragShaderSource, bool binaryRetrievable)
+    {
+        GLuint vertShader{ LoadShader(GL_VERTEX_SHADER, vertShaderSource) };
+        GLuint fragShader{ LoadShader(GL_FRAGMENT_SHADER, fragShaderSource) };
+
+        auto deleteShaders{gsl::finally([vertShader, fragShader]() {
+            glDeleteShader(vertShader);
+            glDeleteShader(fragShader);
+        })};
+
+        return LinkShaderProgram(vertShader, fragShader, binaryRetrievable);
+    }
 }
\ No newline at end of file
@@ -1,51 +1,240 @@
 #include <AndroidExtensions/Permissions.h>
 #include <AndroidExtensions/Globals.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace android;
 using namespace android::global;
 
 namespace android::Permissions
 {
-    // Permission request ID used to uniquely identify our request in the callback when calling requestPermissions.
-    const int PERMISSION_REQUEST_ID{ 8435 };
+    namespace
+    {
+        // First permission request ID passed to requestPermissions. Every request gets its own ID so that results
+        // can be matched to the right request when several are in flight.
+        const int FIRST_PERMISSION_REQUEST_ID{ 8435 };
+
+        // PackageManager.PERMISSION_GRANTED
+        const int32_t PERMISSION_GRANTED{ 0 };
+
+        using PermissionWaiter = std::function<void(bool)>;
+
+        std::mutex g_mutex{};
+        int g_nextRequestId{ FIRST_PERMISSION_REQUEST_ID };
+
+        // Permissions known to be granted. Cleared on resume, since the user may have changed them in the system settings.
+        std::unordered_set<std::string> g_grantedPermissions{};
+
+        // Callers waiting on each permission that is currently being requested.
+        std::unordered_map<std::string, std::vector<PermissionWaiter>> g_inFlightPermissions{};
+
+        // Permissions requested by each outstanding request ID.
+        std::unordered_map<int, std::vector<std::string>> g_outstandingRequests{};
+
+        // Registered once and deliberately never destroyed, since the events they unregister from are statics in
+        // another translation unit and may already be gone during static destruction.
+        RequestPermissionsResultCallbackTicket* g_requestPermissionsResultTicket{};
+        AppStateChangedCallbackTicket* g_resumeTicket{};
+
+        void CompleteRequest(int requestCode, const std::vector<std::string>& permissions, const std::vector<int32_t>& results)
+        {
+            std::vector<std::pair<std::vector<PermissionWaiter>, bool>> completions{};
+
+            {
+                std::lock_guard<std::mutex> guard{ g_mutex };
+                auto request{ g_outstandingRequests.find(requestCode) };
+                if (request == g_outstandingRequests.end())
+                {
+                    return;
+                }
+
+                for (const auto& permission : request->second)
+                {
+                    // The result arrays are empty if the user dismissed the prompt, which is treated as a denial.
+                    auto position{ std::find(permissions.begin(), permissions.end(), permission) };
+                    auto index{ static_cast<size_t>(position - permissions.begin()) };
+                    bool granted{ position != permissions.end() && index < results.size() && results[index] == PERMISSION_GRANTED };
+                    if (granted)
+                    {
+                        g_grantedPermissions.insert(permission);
+                    }
+
+                    auto waiters{ g_inFlightPermissions.find(permission) };
+                    if (waiters != g_inFlightPermissions.end())
+                    {
+                        completions.emplace_back(std::move(waiters->second), granted);
+                        g_inFlightPermissions.erase(waiters);
+                    }
+                }
+
+                g_outstandingRequests.erase(request);
+            }
+
+            for (const auto& [waiters, granted] : completions)
+            {
+                for (const auto& waiter : waiters)
+                {
+                    waiter(granted);
+                }
+            }
+        }
+
+        void EnsureCallbacksRegistered()
+        {
+            if (!g_requestPermissionsResultTicket)
+            {
+                g_requestPermissionsResultTicket = new RequestPermissionsResultCallbackTicket{AddRequestPermissionsResultCallback(&CompleteRequest)};
+            }
+
+            if (!g_resumeTicket)
+            {
+                g_resumeTicket = new AppStateChangedCallbackTicket{AddResumeCallback([]() {
+                    std::lock_guard<std::mutex> guard{ g_mutex };
+                    g_grantedPermissions.clear();
+                })};
+            }
+        }
+
+        // Completes a single task once every permission of a call has a result.
+        struct PendingRequest final
+        {
+            PendingRequest(size_t count)
+                : Remaining{ count }
+            {
+            }
+
+            void OnResult(const std::string& permission, bool granted)
+            {
+                {
+                    std::lock_guard<std::mutex> guard{ Mutex };
+                    if (!granted)
+                    {
+                        Denied.push_back(permission);
+                    }
+
+                    if (--Remaining != 0)
+                    {
+                        return;
+                    }
+                }
+
+                if (Denied.empty())
+                {
+                    Tcs.complete();
+                    return;
+                }
+
+                std::string message{ "Permissions not granted:" };
+                for (const auto& permission : Denied)
+                {
+                    message += " " + permission;
+                }
+
+                Tcs.complete(arcana::make_unexpected(make_exception_ptr(std::runtime_error{ message })));
+            }
+
+            std::mutex Mutex{};
+            size_t Remaining;
+            std::vector<std::string> Denied{};
+            arcana::task_completion_source<void, std::exception_ptr> Tcs{};
+        };
+    }
 
     arcana::task<void, std::exception_ptr> CheckCameraPermissionAsync()
     {
-        auto task{ arcana::task_from_result<std::exception_ptr>() };
+        return RequestPermissionsAsync({ ManifestPermission::Permission::Camera });
+    }
+
+    arcana::task<void, std::exception_ptr> RequestPermissionsAsync(const std::vector<ManifestPermission::Permission>& permissions)
+    {
+        std::vector<std::string> names{};
+        names.reserve(permissions.size());
+        for (auto permission : permissions)
+        {
+            names.push_back(ManifestPermission::GetName(permission));
+        }
+
+        return RequestPermissionsAsync(std::move(names));
+    }
+
+    arcana::task<void, std::exception_ptr> RequestPermissionsAsync(std::vector<std::string> permissions)
+    {
+        std::sort(permissions.begin(), permissions.end());
+        permissions.erase(std::unique(permissions.begin(), permissions.end()), permissions.end());
+
+        {
+            std::lock_guard<std::mutex> guard{ g_mutex };
+            EnsureCallbacksRegistered();
+            permissions.erase(std::remove_if(permissions.begin(), permissions.end(), [](const std::string& permission) {
+                return g_grantedPermissions.count(permission) != 0;
+            }), permissions.end());
+        }
 
         // Check if permissions are already granted.
-        if (!GetAppContext().checkSelfPermission(ManifestPermission::CAMERA()))
+        std::vector<std::string> missingPermissions{};
+        for (const auto& permission : permissions)
+        {
+            if (GetAppContext().checkSelfPermission(java::lang::InternString(permission.c_str())))
+            {
+                std::lock_guard<std::mutex> guard{ g_mutex };
+                g_grantedPermissions.insert(permission);
+            }
+            else
+            {
+                missingPermissions.push_back(permission);
+            }
+        }
+
+        if (missingPermissions.empty())
+        {
+            return arcana::task_from_result<std::exception_ptr>();
+        }
+
+        auto pendingRequest{ std::make_shared<PendingRequest>(missingPermissions.size()) };
+        std::vector<std::string> permissionsToRequest{};
+        int requestId{};
+
         {
-            // Register for the permission callback request.
-            arcana::task_completion_source<void, std::exception_ptr> permissionTcs;
-            auto permissionTicket
+            std::lock_guard<std::mutex> guard{ g_mutex };
+            for (const auto& permission : missingPermissions)
             {
-                AddRequestPermissionsResultCallback(
-                [permissionTcs](int32_t requestCode, const std::vector<std::string>& /*permissionList*/, const std::vector<int32_t>& results) mutable
+                auto& waiters{ g_inFlightPermissions[permission] };
+                if (waiters.empty())
                 {
-                    // Check if this is our permission request ID.
-                    if (requestCode == PERMISSION_REQUEST_ID)
-                    {
-                        // If the permission is found and granted complete the task.
-                        if (results[0] == 0 /* PackageManager.PERMISSION_GRANTED */)
-                        {
-                            permissionTcs.complete();
-                            return;
-                        }
-
-                        // Permission was denied.  Complete the task with an error.
-                        permissionTcs.complete(arcana::make_unexpected(make_exception_ptr(std::runtime_error{"Camera permission not acquired successfully"})));
-                    }
-                })
-            };
+                    permissionsToRequest.push_back(permission);
+                }
+
+                waiters.emplace_back([pendingRequest, permission](bool granted) {
+                    pendingRequest->OnResult(permission, granted);
+                });
+            }
 
-            // Kick off the permission check request, and set the task for our caller to wait on.
-            GetCurrentActivity().requestPermissions(ManifestPermission::CAMERA(), PERMISSION_REQUEST_ID);
-            task = permissionTcs.as_task().then(arcana::inline_scheduler, arcana::cancellation::none(), [ticket{ std::move(permissionTicket) }](){
-                return;
-            });
+            if (!permissionsToRequest.empty())
+            {
+                requestId = g_nextRequestId++;
+                g_outstandingRequests.emplace(requestId, permissionsToRequest);
+            }
+        }
+
+        if (!permissionsToRequest.empty())
+        {
+            try
+            {
+                // Kick off a single permission request for everything that is not already being requested.
+                GetCurrentActivity().requestPermissions(permissionsToRequest, requestId);
+            }
+            catch (...)
+            {
+                // Release everyone waiting on this request, including callers that joined it, before reporting the failure.
+                CompleteRequest(requestId, {}, {});
+                throw;
+            }
         }
 
-        return task;
+        return pendingRequest->Tcs.as_task();
     }
 }
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include <AndroidExtensions/ProgramBinaryCache.h>
+#include <algorithm>
+#include <dirent.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace android::OpenGLHelpers
+{
+    namespace
+    {
+        constexpr uint32_t FILE_MAGIC{0x42505841}; // "AXPB"
+        constexpr uint32_t FILE_VERSION{1};
+        constexpr const char* FILE_EXTENSION{".glbin"};
+
+        struct FileHeader
+        {
+            uint32_t Magic;
+            uint32_t Version;
+            uint64_t Key;
+            uint32_t BinaryFormat;
+            uint32_t Length;
+            uint64_t Checksum;
+        };
+
+        constexpr uint64_t FNV_OFFSET_BASIS{14695981039346656037ull};
+
+        // 64 bit FNV-1a, which is plenty to tell apart the handful of programs an app uses.
+        uint64_t Hash(const void* data, size_t size, uint64_t hash = FNV_OFFSET_BASIS)
+        {
+            const auto* bytes{static_cast<const uint8_t*>(data)};
+            for (size_t index = 0; index < size; ++index)
+            {
+                hash ^= bytes[index];
+                hash *= 1099511628211ull;
+            }
+
+            return hash;
+        }
+
+        // Includes the terminator so that moving text from the end of one string to the start of the next changes the hash.
+        uint64_t HashString(const char* string, uint64_t hash)
+        {
+            return Hash(string, std::strlen(string) + 1, hash);
+        }
+
+        bool EndsWith(const char* string, const char* suffix)
+        {
+            const size_t length{std::strlen(string)};
+            const size_t suffixLength{std::strlen(suffix)};
+            return length >= suffixLength && std::strcmp(string + length - suffixLength, suffix) == 0;
+        }
+    }
+
+    ProgramBinaryCache::ProgramBinaryCache(std::string directory)
+        : m_directory{std::move(directory)}
+    {
+    }
+
+    GLuint ProgramBinaryCache::CreateShaderProgram(const char* vertShaderSource, const char* fragShaderSource)
+    {
+        const uint64_t key{GetKey(vertShaderSource, fragShaderSource)};
+
+        GLuint program{ TryLoad(key) };
+        if (program)
+        {
+            return program;
+        }
+
+        program = OpenGLHelpers::CreateShaderProgram(vertShaderSource, fragShaderSource, true);
+        Store(key, program);
+        return program;
+    }
+
+    uint64_t ProgramBinaryCache::GetKey(const char* vertShaderSource, const char* fragShaderSource)
+    {
+        InitializeDriverInfo();
+        return HashString(fragShaderSource, HashString(vertShaderSource, m_driverHash));
+    }
+
+    GLuint ProgramBinaryCache::TryLoad(uint64_t key)
+    {
+        InitializeDriverInfo();
+        if (!m_supported)
+        {
+            ++m_misses;
+            return 0;
+        }
+
+        const std::string path{GetPath(key)};
+        std::ifstream stream{path, std::ios::binary | std::ios::ate};
+        const std::streamoff fileSize{stream ? static_cast<std::streamoff>(stream.tellg()) : std::streamoff{}};
+        FileHeader header{};
+        if (fileSize < static_cast<std::streamoff>(sizeof(header)) ||
+            !stream.seekg(0) ||
+            !stream.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        {
+            ++m_misses;
+            return 0;
+        }
+
+        // The header is validated against the actual file size before anything is allocated for the binary.
+        if (header.Magic != FILE_MAGIC || header.Version != FILE_VERSION || header.Key != key ||
+            header.Length != static_cast<uint64_t>(fileSize) - sizeof(header))
+        {
+            // Truncated or stale files are treated as misses and overwritten by the next Store.
+            ++m_misses;
+            return 0;
+        }
+
+        // Formats the driver no longer accepts are rejected here, since glProgramBinary would raise GL_INVALID_ENUM
+        // for them, which cannot be told apart from errors the caller left pending.
+        if (std::find(m_binaryFormats.begin(), m_binaryFormats.end(), static_cast<GLint>(header.BinaryFormat)) == m_binaryFormats.end())
+        {
+            std::remove(path.c_str());
+            ++m_rejected;
+            ++m_misses;
+            return 0;
+        }
+
+        std::vector<char> binary(header.Length);
+        if (!stream.read(binary.data(), static_cast<std::streamsize>(binary.size())) ||
+            Hash(binary.data(), binary.size()) != header.Checksum)
+        {
+            ++m_misses;
+            return 0;
+        }
+
+        GLuint program{ glCreateProgram() };
+        if (!program)
+        {
+            throw std::runtime_error{"Failed to create shader program"};
+        }
+
+        glProgramBinary(program, header.BinaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+
+        // A binary in a supported format that the driver still refuses only fails the link, without raising a GL
+        // error, so the link status alone decides and errors the caller left pending are untouched.
+        GLint linkStatus{ GL_FALSE };
+        glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+
+        if (linkStatus != GL_TRUE)
+        {
+            glDeleteProgram(program);
+            std::remove(path.c_str());
+            ++m_rejected;
+            ++m_misses;
+            return 0;
+        }
+
+        ++m_hits;
+        return program;
+    }
+
+    void ProgramBinaryCache::Store(uint64_t key, GLuint program)
+    {
+        InitializeDriverInfo();
+        if (!m_supported)
+        {
+            return;
+        }
+
+        GLint length{};
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+        {
+            return;
+        }
+
+        // A failed query leaves written untouched, which avoids having to consult glGetError.
+        std::vector<char> binary(static_cast<size_t>(length));
+        GLenum binaryFormat{};
+        GLsizei written{};
+        glGetProgramBinary(program, length, &written, &binaryFormat, binary.data());
+        if (written <= 0)
+        {
+            return;
+        }
+
+        binary.resize(static_cast<size_t>(written));
+        const FileHeader header{FILE_MAGIC, FILE_VERSION, key, binaryFormat, static_cast<uint32_t>(binary.size()), Hash(binary.data(), binary.size())};
+
+        // Written to a temporary file and renamed into place, so a crash or a concurrent
+        // launch never observes a partially written binary.
+        const std::string path{GetPath(key)};
+        const std::string temporaryPath{path + "." + std::to_string(getpid()) + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp"};
+        {
+            std::ofstream stream{temporaryPath, std::ios::binary | std::ios::trunc};
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            stream.write(binary.data(), static_cast<std::streamsize>(binary.size()));
+            stream.close();
+            if (!stream)
+            {
+                std::remove(temporaryPath.c_str());
+                return;
+            }
+        }
+
+        if (std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+        {
+            std::remove(temporaryPath.c_str());
+        }
+    }
+
+    void ProgramBinaryCache::Clear()
+    {
+        DIR* directory{ opendir(m_directory.c_str()) };
+        if (!directory)
+        {
+            return;
+        }
+
+        while (const dirent* entry{ readdir(directory) })
+        {
+            if (EndsWith(entry->d_name, FILE_EXTENSION))
+            {
+                std::remove((m_directory + "/" + entry->d_name).c_str());
+            }
+        }
+
+        closedir(directory);
+    }
+
+    ProgramBinaryCache::Statistics ProgramBinaryCache::GetStatistics() const
+    {
+        return {m_hits.load(), m_misses.load(), m_rejected.load()};
+    }
+
+    void ProgramBinaryCache::InitializeDriverInfo()
+    {
+        std::call_once(m_driverInfoOnce, [this]() {
+            // Drivers without any binary formats cannot load anything, so the cache only counts misses.
+            GLint formatCount{};
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+            m_supported = formatCount > 0;
+            if (m_supported)
+            {
+                m_binaryFormats.resize(static_cast<size_t>(formatCount));
+                glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, m_binaryFormats.data());
+            }
+
+            const auto* renderer{reinterpret_cast<const char*>(glGetString(GL_RENDERER))};
+            const auto* version{reinterpret_cast<const char*>(glGetString(GL_VERSION))};
+            m_driverHash = HashString(version ? version : "", HashString(renderer ? renderer : "", FNV_OFFSET_BASIS));
+        });
+    }
+
+    std::string ProgramBinaryCache::GetPath(uint64_t key) const
+    {
+        char name[32]{};
+        std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+        return m_directory + "/" + name + FILE_EXTENSION;
+    }
+}
@@ -0,0 +1,441 @@
+#include <AndroidExtensions/ResourcePool.h>
+#include <AndroidExtensions/StateScope.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+namespace android::OpenGLHelpers
+{
+    namespace
+    {
+        enum class ResourceType
+        {
+            Texture,
+            Buffer,
+            RenderTarget,
+        };
+
+        size_t GetBytesPerPixel(GLenum format)
+        {
+            switch (format)
+            {
+                case GL_R8:
+                case GL_STENCIL_INDEX8:
+                    return 1;
+                case GL_RG8:
+                case GL_R16F:
+                case GL_RGB565:
+                case GL_RGBA4:
+                case GL_RGB5_A1:
+                case GL_DEPTH_COMPONENT16:
+                    return 2;
+                case GL_RGB8:
+                case GL_SRGB8:
+                    return 3;
+                case GL_RGBA16F:
+                case GL_RG32F:
+                case GL_DEPTH32F_STENCIL8:
+                    return 8;
+                case GL_RGBA32F:
+                    return 16;
+                default:
+                    // Covers RGBA8, SRGB8_ALPHA8, RGB10_A2, R11F_G11F_B10F, RG16F, R32F and the 32 bit depth formats.
+                    return 4;
+            }
+        }
+
+        size_t GetTextureBytes(GLenum format, GLsizei width, GLsizei height, GLsizei levels)
+        {
+            size_t bytes{};
+            for (GLsizei level = 0; level < levels; ++level)
+            {
+                bytes += static_cast<size_t>(std::max(width >> level, 1)) * static_cast<size_t>(std::max(height >> level, 1)) * GetBytesPerPixel(format);
+            }
+
+            return bytes;
+        }
+
+        GLenum GetDepthStencilAttachment(GLenum format)
+        {
+            switch (format)
+            {
+                case GL_DEPTH24_STENCIL8:
+                case GL_DEPTH32F_STENCIL8:
+                    return GL_DEPTH_STENCIL_ATTACHMENT;
+                case GL_STENCIL_INDEX8:
+                    return GL_STENCIL_ATTACHMENT;
+                default:
+                    return GL_DEPTH_ATTACHMENT;
+            }
+        }
+    }
+
+    struct ResourcePool::Resource final
+    {
+        bool Matches(const Resource& other) const
+        {
+            return Type == other.Type && Target == other.Target && Format == other.Format && Width == other.Width && Height == other.Height &&
+                Levels == other.Levels && Size == other.Size && Usage == other.Usage && DepthStencilFormat == other.DepthStencilFormat;
+        }
+
+        ResourceType Type{};
+        GLenum Target{};
+        GLenum Format{};
+        GLsizei Width{};
+        GLsizei Height{};
+        GLsizei Levels{};
+        GLsizeiptr Size{};
+        GLenum Usage{};
+        GLenum DepthStencilFormat{};
+
+        // Texture or buffer; or framebuffer, color texture and depth/stencil renderbuffer.
+        std::array<GLuint, 3> Names{};
+        size_t Bytes{};
+    };
+
+    struct ResourcePool::State final
+    {
+        static void Create(Resource& resource)
+        {
+            GLTransactions::StateScope scope{};
+            StateShadow& state{StateShadow::Current()};
+
+            switch (resource.Type)
+            {
+                case ResourceType::Texture:
+                {
+                    glGenTextures(1, &resource.Names[0]);
+                    scope.BindTexture(state.GetActiveTexture(), resource.Target, resource.Names[0]);
+                    glTexStorage2D(resource.Target, resource.Levels, resource.Format, resource.Width, resource.Height);
+                    resource.Bytes = GetTextureBytes(resource.Format, resource.Width, resource.Height, resource.Levels) * (resource.Target == GL_TEXTURE_CUBE_MAP ? 6 : 1);
+                    break;
+                }
+                case ResourceType::Buffer:
+                {
+                    glGenBuffers(1, &resource.Names[0]);
+                    scope.BindBuffer(GL_COPY_WRITE_BUFFER, resource.Names[0]);
+                    glBufferData(GL_COPY_WRITE_BUFFER, resource.Size, nullptr, resource.Usage);
+                    resource.Bytes = static_cast<size_t>(resource.Size);
+                    break;
+                }
+                case ResourceType::RenderTarget:
+                {
+                    glGenFramebuffers(1, &resource.Names[0]);
+                    glGenTextures(1, &resource.Names[1]);
+                    scope.BindTexture(state.GetActiveTexture(), GL_TEXTURE_2D, resource.Names[1]);
+                    glTexStorage2D(GL_TEXTURE_2D, 1, resource.Format, resource.Width, resource.Height);
+                    scope.BindFramebuffer(GL_FRAMEBUFFER, resource.Names[0]);
+                    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, resource.Names[1], 0);
+                    resource.Bytes = GetTextureBytes(resource.Format, resource.Width, resource.Height, 1);
+
+                    if (resource.DepthStencilFormat != GL_NONE)
+                    {
+                        // The renderbuffer binding is not shadowed, and is only queried here since creation is rare.
+                        GLint previousRenderbuffer{};
+                        glGetIntegerv(GL_RENDERBUFFER_BINDING, &previousRenderbuffer);
+                        glGenRenderbuffers(1, &resource.Names[2]);
+                        glBindRenderbuffer(GL_RENDERBUFFER, resource.Names[2]);
+                        glRenderbufferStorage(GL_RENDERBUFFER, resource.DepthStencilFormat, resource.Width, resource.Height);
+                        glBindRenderbuffer(GL_RENDERBUFFER, static_cast<GLuint>(previousRenderbuffer));
+                        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GetDepthStencilAttachment(resource.DepthStencilFormat), GL_RENDERBUFFER, resource.Names[2]);
+                        resource.Bytes += GetTextureBytes(resource.DepthStencilFormat, resource.Width, resource.Height, 1);
+                    }
+
+                    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+                    {
+                        Destroy(resource);
+                        throw std::runtime_error{"Render target is incomplete"};
+                    }
+
+                    break;
+                }
+            }
+        }
+
+        static void Destroy(Resource& resource)
+        {
+            StateShadow& state{StateShadow::Current()};
+            switch (resource.Type)
+            {
+                case ResourceType::Texture:
+                    state.DeleteTextures(1, &resource.Names[0]);
+                    break;
+                case ResourceType::Buffer:
+                    state.DeleteBuffers(1, &resource.Names[0]);
+                    break;
+                case ResourceType::RenderTarget:
+                    state.DeleteFramebuffers(1, &resource.Names[0]);
+                    state.DeleteTextures(1, &resource.Names[1]);
+                    if (resource.Names[2])
+                    {
+                        glDeleteRenderbuffers(1, &resource.Names[2]);
+                    }
+                    break;
+            }
+
+            resource.Names = {};
+        }
+
+        // Deletes idle resources, least recently released first. Must be called without holding the mutex.
+        size_t Trim(size_t bytesToRelease)
+        {
+            std::vector<std::unique_ptr<Resource>> released{};
+            {
+                std::lock_guard<std::mutex> guard{Mutex};
+                size_t bytes{};
+                while (!Idle.empty() && bytes < bytesToRelease)
+                {
+                    bytes += Idle.front()->Bytes;
+                    IdleBytes -= Idle.front()->Bytes;
+                    released.push_back(std::move(Idle.front()));
+                    Idle.pop_front();
+                }
+
+                Deleted += released.size();
+            }
+
+            size_t bytes{};
+            for (auto& resource : released)
+            {
+                bytes += resource->Bytes;
+                Destroy(*resource);
+            }
+
+            return bytes;
+        }
+
+        size_t ProcessPendingTrim()
+        {
+            const size_t bytesToRelease{PendingTrim.exchange(0)};
+            return bytesToRelease != 0 ? Trim(bytesToRelease) : 0;
+        }
+
+        mutable std::mutex Mutex{};
+        bool Alive{true};
+
+        // Ordered from least to most recently released.
+        std::deque<std::unique_ptr<Resource>> Idle{};
+        size_t IdleBytes{};
+        size_t InUse{};
+        size_t InUseBytes{};
+        size_t Created{};
+        size_t Reused{};
+        size_t Deleted{};
+
+        std::atomic<size_t> PendingTrim{};
+    };
+
+    ResourcePool::Handle::Handle() = default;
+
+    ResourcePool::Handle::Handle(std::shared_ptr<State> state, std::unique_ptr<Resource> resource)
+        : m_state{std::move(state)}
+        , m_resource{std::move(resource)}
+    {
+    }
+
+    ResourcePool::Handle::~Handle()
+    {
+        Release();
+    }
+
+    ResourcePool::Handle::Handle(Handle&&) noexcept = default;
+
+    ResourcePool::Handle& ResourcePool::Handle::operator=(Handle&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Release();
+            m_state = std::move(other.m_state);
+            m_resource = std::move(other.m_resource);
+        }
+
+        return *this;
+    }
+
+    ResourcePool::Handle::operator bool() const
+    {
+        return m_resource != nullptr;
+    }
+
+    void ResourcePool::Handle::Release()
+    {
+        if (!m_resource)
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> guard{m_state->Mutex};
+            m_state->InUse -= 1;
+            m_state->InUseBytes -= m_resource->Bytes;
+
+            if (m_state->Alive)
+            {
+                m_state->IdleBytes += m_resource->Bytes;
+                m_state->Idle.push_back(std::move(m_resource));
+            }
+        }
+
+        if (m_resource)
+        {
+            State::Destroy(*m_resource);
+            m_resource.reset();
+        }
+
+        m_state.reset();
+    }
+
+    GLuint ResourcePool::Handle::GetName(size_t index) const
+    {
+        return m_resource ? m_resource->Names[index] : 0;
+    }
+
+    GLuint ResourcePool::Texture::Name() const
+    {
+        return GetName(0);
+    }
+
+    GLuint ResourcePool::Buffer::Name() const
+    {
+        return GetName(0);
+    }
+
+    GLuint ResourcePool::RenderTarget::Framebuffer() const
+    {
+        return GetName(0);
+    }
+
+    GLuint ResourcePool::RenderTarget::ColorTexture() const
+    {
+        return GetName(1);
+    }
+
+    ResourcePool::ResourcePool(std::string name, int32_t trimPriority, global::CallbackDispatcher trimDispatcher)
+        : m_state{std::make_shared<State>()}
+        , m_cacheTicket{MemoryPressure::RegisterCache(std::move(name), trimPriority,
+            [state{m_state}]() {
+                std::lock_guard<std::mutex> guard{state->Mutex};
+                return state->IdleBytes;
+            },
+            [state{m_state}, trimDispatcher{std::move(trimDispatcher)}](size_t bytesToRelease) {
+                // GL objects can only be deleted on the context's thread, so the bytes are released there later.
+                state->PendingTrim.fetch_add(bytesToRelease);
+                if (trimDispatcher)
+                {
+                    trimDispatcher([state]() {
+                        {
+                            std::lock_guard<std::mutex> guard{state->Mutex};
+                            if (!state->Alive)
+                            {
+                                return;
+                            }
+                        }
+
+                        state->ProcessPendingTrim();
+                    });
+                }
+
+                // Nothing has been released yet, so lower priority caches are still asked to trim.
+                return size_t{0};
+            })}
+    {
+    }
+
+    ResourcePool::~ResourcePool()
+    {
+        {
+            std::lock_guard<std::mutex> guard{m_state->Mutex};
+            m_state->Alive = false;
+        }
+
+        m_state->Trim(std::numeric_limits<size_t>::max());
+    }
+
+    ResourcePool::Texture ResourcePool::AcquireTexture(const TextureDescription& description)
+    {
+        if (description.Target != GL_TEXTURE_2D && description.Target != GL_TEXTURE_CUBE_MAP)
+        {
+            throw std::runtime_error{"Only 2D and cube map textures can be pooled"};
+        }
+
+        Resource key{};
+        key.Type = ResourceType::Texture;
+        key.Target = description.Target;
+        key.Format = description.InternalFormat;
+        key.Width = description.Width;
+        key.Height = description.Height;
+        key.Levels = description.Levels;
+        return {m_state, Acquire(key)};
+    }
+
+    ResourcePool::Buffer ResourcePool::AcquireBuffer(const BufferDescription& description)
+    {
+        Resource key{};
+        key.Type = ResourceType::Buffer;
+        key.Size = description.Size;
+        key.Usage = description.Usage;
+        return {m_state, Acquire(key)};
+    }
+
+    ResourcePool::RenderTarget ResourcePool::AcquireRenderTarget(const RenderTargetDescription& description)
+    {
+        Resource key{};
+        key.Type = ResourceType::RenderTarget;
+        key.Format = description.ColorFormat;
+        key.Width = description.Width;
+        key.Height = description.Height;
+        key.DepthStencilFormat = description.DepthStencilFormat;
+        return {m_state, Acquire(key)};
+    }
+
+    size_t ResourcePool::Trim(size_t bytesToRelease)
+    {
+        return m_state->Trim(bytesToRelease);
+    }
+
+    void ResourcePool::ProcessPendingTrim()
+    {
+        m_state->ProcessPendingTrim();
+    }
+
+    ResourcePool::Statistics ResourcePool::GetStatistics() const
+    {
+        std::lock_guard<std::mutex> guard{m_state->Mutex};
+        return {m_state->Created, m_state->Reused, m_state->Deleted, m_state->InUse, m_state->Idle.size(), m_state->InUseBytes, m_state->IdleBytes};
+    }
+
+    std::unique_ptr<ResourcePool::Resource> ResourcePool::Acquire(const Resource& key)
+    {
+        {
+            std::lock_guard<std::mutex> guard{m_state->Mutex};
+
+            // Most recently released first, since its memory is the most likely to still be resident.
+            for (auto it = m_state->Idle.rbegin(); it != m_state->Idle.rend(); ++it)
+            {
+                if ((*it)->Matches(key))
+                {
+                    auto resource{std::move(*it)};
+                    m_state->Idle.erase(std::next(it).base());
+                    m_state->IdleBytes -= resource->Bytes;
+                    m_state->InUse += 1;
+                    m_state->InUseBytes += resource->Bytes;
+                    m_state->Reused += 1;
+                    return resource;
+                }
+            }
+        }
+
+        auto resource{std::make_unique<Resource>(key)};
+        State::Create(*resource);
+
+        std::lock_guard<std::mutex> guard{m_state->Mutex};
+        m_state->InUse += 1;
+        m_state->InUseBytes += resource->Bytes;
+        m_state->Created += 1;
+        return resource;
+    }
+}
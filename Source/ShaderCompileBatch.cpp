@@ -0,0 +1,243 @@
+#include <AndroidExtensions/ShaderCompileBatch.h>
+#include <AndroidExtensions/ProgramBinaryCache.h>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace android::OpenGLHelpers
+{
+    namespace
+    {
+        bool HasExtension(const char* name)
+        {
+            const auto* extensions{reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS))};
+            if (!extensions)
+            {
+                return false;
+            }
+
+            // Extension names are space separated, so only whole tokens count as a match.
+            const size_t length{std::strlen(name)};
+            for (const char* position{extensions}; (position = std::strstr(position, name)) != nullptr; position += length)
+            {
+                const bool startsToken{position == extensions || position[-1] == ' '};
+                const bool endsToken{position[length] == ' ' || position[length] == '\0'};
+                if (startsToken && endsToken)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        GLuint CreateShader(GLenum shaderType, const char* shaderSource)
+        {
+            GLuint shader{ glCreateShader(shaderType) };
+            if (!shader)
+            {
+                throw std::runtime_error{"Failed to create shader"};
+            }
+
+            glShaderSource(shader, 1, &shaderSource, nullptr);
+            glCompileShader(shader);
+            return shader;
+        }
+
+        std::string GetShaderError(GLuint shader)
+        {
+            GLint compileStatus{ GL_FALSE };
+            glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
+            if (compileStatus == GL_TRUE)
+            {
+                return {};
+            }
+
+            GLint infoLogLength{};
+            glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLogLength);
+            if (!infoLogLength)
+            {
+                return "Unknown error compiling shader";
+            }
+
+            std::string infoLog;
+            infoLog.resize(static_cast<size_t>(infoLogLength));
+            glGetShaderInfoLog(shader, infoLogLength, nullptr, infoLog.data());
+            return "Error compiling shader: " + infoLog;
+        }
+
+        std::string GetProgramError(GLuint program)
+        {
+            GLint infoLogLength{};
+            glGetProgramiv(program, GL_INFO_LOG_LENGTH, &infoLogLength);
+            if (!infoLogLength)
+            {
+                return "Unknown error linking shader program";
+            }
+
+            std::string infoLog;
+            infoLog.resize(static_cast<size_t>(infoLogLength));
+            glGetProgramInfoLog(program, infoLogLength, nullptr, infoLog.data());
+            return "Error linking shader program: " + infoLog;
+        }
+    }
+
+    ShaderCompileBatch::ShaderCompileBatch(ProgramBinaryCache* cache)
+        : m_cache{cache}
+        , m_parallel{HasExtension("GL_KHR_parallel_shader_compile")}
+    {
+        if (m_parallel)
+        {
+            // The entry point is not exported by libGLESv3, so it has to be looked up. 0xFFFFFFFF lets the driver
+            // pick the number of compiler threads.
+            auto maxShaderCompilerThreads{reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(eglGetProcAddress("glMaxShaderCompilerThreadsKHR"))};
+            if (maxShaderCompilerThreads)
+            {
+                maxShaderCompilerThreads(0xFFFFFFFF);
+            }
+        }
+    }
+
+    ShaderCompileBatch::~ShaderCompileBatch()
+    {
+        // Programs that were never waited for are still completed, so no task is left hanging.
+        Finish();
+    }
+
+    arcana::task<GLuint, std::exception_ptr> ShaderCompileBatch::Add(const char* vertShaderSource, const char* fragShaderSource)
+    {
+        uint64_t cacheKey{};
+        if (m_cache)
+        {
+            cacheKey = m_cache->GetKey(vertShaderSource, fragShaderSource);
+            if (GLuint program{ m_cache->TryLoad(cacheKey) })
+            {
+                return arcana::task_from_result<std::exception_ptr>(program);
+            }
+        }
+
+        GLuint vertShader{ CreateShader(GL_VERTEX_SHADER, vertShaderSource) };
+        GLuint fragShader{ CreateShader(GL_FRAGMENT_SHADER, fragShaderSource) };
+
+        GLuint program{ glCreateProgram() };
+        if (!program)
+        {
+            glDeleteShader(vertShader);
+            glDeleteShader(fragShader);
+            throw std::runtime_error{"Failed to create shader program"};
+        }
+
+        glAttachShader(program, vertShader);
+        glAttachShader(program, fragShader);
+
+        if (m_cache)
+        {
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+
+        // Linking right away is fine even though the compile status is unknown, since a failed compile just fails the
+        // link, and it lets the driver overlap the link with the following compiles.
+        glLinkProgram(program);
+
+        m_pending.push_back({vertShader, fragShader, program, cacheKey, {}});
+        return m_pending.back().Tcs.as_task();
+    }
+
+    size_t ShaderCompileBatch::Poll()
+    {
+        if (!m_parallel)
+        {
+            Finish();
+            return 0;
+        }
+
+        // Pending programs are moved out before their tasks complete, since continuations may call Add.
+        std::vector<PendingProgram> completed{};
+        for (auto it = m_pending.begin(); it != m_pending.end();)
+        {
+            GLint completionStatus{ GL_FALSE };
+            glGetProgramiv(it->Program, GL_COMPLETION_STATUS_KHR, &completionStatus);
+            if (completionStatus == GL_TRUE)
+            {
+                completed.push_back(std::move(*it));
+                it = m_pending.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        for (auto& pending : completed)
+        {
+            Complete(pending);
+        }
+
+        return m_pending.size();
+    }
+
+    void ShaderCompileBatch::Finish()
+    {
+        while (!m_pending.empty())
+        {
+            auto pending{std::move(m_pending)};
+            m_pending.clear();
+
+            for (auto& program : pending)
+            {
+                Complete(program);
+            }
+        }
+    }
+
+    size_t ShaderCompileBatch::Pending() const
+    {
+        return m_pending.size();
+    }
+
+    bool ShaderCompileBatch::IsParallel() const
+    {
+        return m_parallel;
+    }
+
+    void ShaderCompileBatch::Complete(PendingProgram& pending)
+    {
+        GLint linkStatus{ GL_FALSE };
+        glGetProgramiv(pending.Program, GL_LINK_STATUS, &linkStatus);
+
+        std::string error{};
+        if (linkStatus != GL_TRUE)
+        {
+            // Compile errors are more useful than the link error they cause, so they are reported first.
+            error = GetShaderError(pending.VertShader);
+            if (error.empty())
+            {
+                error = GetShaderError(pending.FragShader);
+            }
+
+            if (error.empty())
+            {
+                error = GetProgramError(pending.Program);
+            }
+        }
+
+        glDetachShader(pending.Program, pending.VertShader);
+        glDeleteShader(pending.VertShader);
+        glDetachShader(pending.Program, pending.FragShader);
+        glDeleteShader(pending.FragShader);
+
+        if (!error.empty())
+        {
+            glDeleteProgram(pending.Program);
+            pending.Tcs.complete(arcana::make_unexpected(std::make_exception_ptr(std::runtime_error{error})));
+            return;
+        }
+
+        if (m_cache)
+        {
+            m_cache->Store(pending.CacheKey, pending.Program);
+        }
+
+        pending.Tcs.complete(pending.Program);
+    }
+}
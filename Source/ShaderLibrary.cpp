@@ -0,0 +1,158 @@
+#include <AndroidExtensions/ShaderLibrary.h>
+#include <AndroidExtensions/ProgramBinaryCache.h>
+
+namespace android::OpenGLHelpers
+{
+    namespace
+    {
+        constexpr std::string_view VERSION_DIRECTIVE{"#version"};
+
+        // Returns the offset just past the line holding the #version directive, or 0 if there is none.
+        size_t FindVersionEnd(std::string_view source)
+        {
+            const size_t start{source.find_first_not_of(" \t\r\n")};
+            if (start == std::string_view::npos || source.substr(start, VERSION_DIRECTIVE.size()) != VERSION_DIRECTIVE)
+            {
+                return 0;
+            }
+
+            const size_t lineEnd{source.find('\n', start)};
+            return lineEnd == std::string_view::npos ? source.size() : lineEnd + 1;
+        }
+    }
+
+    ShaderLibrary::ShaderLibrary(ProgramBinaryCache* cache)
+        : m_cache{cache}
+    {
+    }
+
+    ShaderLibrary::~ShaderLibrary()
+    {
+        Clear();
+    }
+
+    std::string ShaderLibrary::Preprocess(std::string_view source, const Defines& defines)
+    {
+        const size_t versionEnd{FindVersionEnd(source)};
+
+        std::string result{};
+        result.reserve(source.size() + defines.size() * 32);
+        result.append(source.substr(0, versionEnd));
+
+        // A #version directive on the last line has no newline to separate it from the defines.
+        if (versionEnd != 0 && result.back() != '\n')
+        {
+            result.push_back('\n');
+        }
+
+        for (const auto& [name, value] : defines)
+        {
+            result.append("#define ").append(name);
+            if (!value.empty())
+            {
+                result.append(" ").append(value);
+            }
+
+            result.push_back('\n');
+        }
+
+        result.append(source.substr(versionEnd));
+        return result;
+    }
+
+    GLuint ShaderLibrary::GetProgram(std::string_view vertShaderSource, std::string_view fragShaderSource, const Defines& defines)
+    {
+        return GetProgram(vertShaderSource, defines, fragShaderSource, defines);
+    }
+
+    GLuint ShaderLibrary::GetProgram(std::string_view vertShaderSource, const Defines& vertDefines, std::string_view fragShaderSource, const Defines& fragDefines)
+    {
+        auto& vertEntry{*m_vertShaders.try_emplace(Preprocess(vertShaderSource, vertDefines), 0).first};
+        auto& fragEntry{*m_fragShaders.try_emplace(Preprocess(fragShaderSource, fragDefines), 0).first};
+
+        const auto [programEntry, inserted]{m_programs.try_emplace({&vertEntry.first, &fragEntry.first}, 0)};
+        if (!inserted && programEntry->second)
+        {
+            ++m_programHits;
+            return programEntry->second;
+        }
+
+        // Variants that fail to build are not kept, so the error is reported again the next time they are requested.
+        auto removeFailed{gsl::finally([this, &programEntry = programEntry]() {
+            if (!programEntry->second)
+            {
+                m_programs.erase(programEntry);
+            }
+        })};
+
+        uint64_t cacheKey{};
+        if (m_cache)
+        {
+            cacheKey = m_cache->GetKey(vertEntry.first.c_str(), fragEntry.first.c_str());
+            programEntry->second = m_cache->TryLoad(cacheKey);
+            if (programEntry->second)
+            {
+                return programEntry->second;
+            }
+        }
+
+        programEntry->second = LinkShaderProgram(GetShader(vertEntry, GL_VERTEX_SHADER), GetShader(fragEntry, GL_FRAGMENT_SHADER), m_cache != nullptr);
+
+        if (m_cache)
+        {
+            m_cache->Store(cacheKey, programEntry->second);
+        }
+
+        return programEntry->second;
+    }
+
+    void ShaderLibrary::Clear()
+    {
+        for (const auto& [key, program] : m_programs)
+        {
+            glDeleteProgram(program);
+        }
+
+        for (const auto* sources : {&m_vertShaders, &m_fragShaders})
+        {
+            for (const auto& [source, shader] : *sources)
+            {
+                if (shader)
+                {
+                    glDeleteShader(shader);
+                }
+            }
+        }
+
+        m_programs.clear();
+        m_vertShaders.clear();
+        m_fragShaders.clear();
+    }
+
+    ShaderLibrary::Statistics ShaderLibrary::GetStatistics() const
+    {
+        // Sources of programs that were loaded from the binary cache are tracked but never compiled.
+        size_t shaders{};
+        for (const auto* sources : {&m_vertShaders, &m_fragShaders})
+        {
+            for (const auto& [source, shader] : *sources)
+            {
+                shaders += shader ? 1 : 0;
+            }
+        }
+
+        return {shaders, m_programs.size(), m_shaderHits, m_programHits};
+    }
+
+    GLuint ShaderLibrary::GetShader(SourceMap::value_type& entry, GLenum shaderType)
+    {
+        if (entry.second)
+        {
+            ++m_shaderHits;
+            return entry.second;
+        }
+
+        entry.second = LoadShader(shaderType, entry.first.c_str());
+        return entry.second;
+    }
+}
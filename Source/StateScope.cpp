@@ -0,0 +1,227 @@
+#include <AndroidExtensions/StateScope.h>
+#include <algorithm>
+
+namespace android::OpenGLHelpers::GLTransactions
+{
+    StateScope::StateScope()
+        : m_state{StateShadow::Current()}
+    {
+    }
+
+    StateScope::~StateScope()
+    {
+        // Restoring texture bindings switches the active unit, so the active unit itself is restored last.
+        const SavedState* activeTexture{};
+        for (auto it = m_saved.rbegin(); it != m_saved.rend(); ++it)
+        {
+            if (it->Type == StateType::ActiveTexture)
+            {
+                activeTexture = &*it;
+            }
+            else
+            {
+                it->Restore(m_state);
+            }
+        }
+
+        if (activeTexture)
+        {
+            activeTexture->Restore(m_state);
+        }
+    }
+
+    StateScope& StateScope::SetEnabled(GLenum capability, bool enabled)
+    {
+        const bool previous{m_state.IsEnabled(capability)};
+        if (previous != enabled)
+        {
+            Save(StateType::Capability, capability, [capability, previous](StateShadow& state) { state.SetEnabled(capability, previous); });
+            m_state.SetEnabled(capability, enabled);
+        }
+
+        return *this;
+    }
+
+    StateScope& StateScope::SetStencilWriteMask(GLuint mask)
+    {
+        const GLuint previous{m_state.GetStencilWriteMask()};
+        if (previous != mask)
+        {
+            Save(StateType::StencilWriteMask, 0, [previous](StateShadow& state) { state.SetStencilWriteMask(previous); });
+            m_state.SetStencilWriteMask(mask);
+        }
+
+        return *this;
+    }
+
+    StateScope& StateScope::SetBlendFunc(const BlendFunc& blendFunc)
+    {
+        const BlendFunc previous{m_state.GetBlendFunc()};
+        if (previous != blendFunc)
+        {
+            Save(StateType::BlendFunc, 0, [previous](StateShadow& state) { state.SetBlendFunc(previous); });
+            m_state.SetBlendFunc(blendFunc);
+        }
+
+        return *this;
+    }
+
+    StateScope& StateScope::SetDepthWriteMask(bool enabled)
+    {
+        const bool previous{m_state.GetDepthWriteMask()};
+        if (previous != enabled)
+        {
+            Save(StateType::DepthWriteMask, 0, [previous](StateShadow& state) { state.SetDepthWriteMask(previous); });
+            m_state.SetDepthWriteMask(enabled);
+        }
+
+        return *this;
+    }
+
+    StateScope& StateScope::SetDepthFunc(GLenum func)
+    {
+        const GLenum previous{m_state.GetDepthFunc()};
+        if (previous != func)
+        {
+            Save(StateType::DepthFunc, 0, [previous](StateShadow& state) { state.SetDepthFunc(previous); });
+            m_state.SetDepthFunc(func);
+        }
+
+        return *this;
+    }
+
+    StateScope& StateScope::SetViewport(const Rect& viewport)
+    {
+        const Rect previous{m_state.GetViewport()};
+        if (previous != viewport)
+        {
+            Save(StateType::Viewport, 0, [previous](StateShadow& state) { state.SetViewport(previous); });
+            m_state.SetViewport(viewport);
+        }
+
+        return *this;
+    }
+
+    StateScope& StateScope::SetScissor(const Rect& scissor)
+    {
+        const Rect previous{m_state.GetScissor()};
+        if (previous != scissor)
+        {
+            Save(StateType::Scissor, 0, [previous](StateShadow& state) { state.SetScissor(previous); });
+            m_state.SetScissor(scissor);
+        }
+
+        return *this;
+    }
+
+    StateScope& StateScope::UseProgram(GLuint program)
+    {
+        const GLuint previous{m_state.GetProgram()};
+        if (previous != program)
+        {
+            Save(StateType::Program, 0, [previous](StateShadow& state) { state.UseProgram(previous); });
+            m_state.UseProgram(program);
+        }
+
+        return *this;
+    }
+
+    StateScope& StateScope::SetActiveTexture(GLenum unit)
+    {
+        const GLenum previous{m_state.GetActiveTexture()};
+        if (previous != unit)
+        {
+            Save(StateType::ActiveTexture, 0, [previous](StateShadow& state) { state.SetActiveTexture(previous); });
+            m_state.SetActiveTexture(unit);
+        }
+
+        return *this;
+    }
+
+    StateScope& StateScope::BindTexture(GLenum unit, GLenum target, GLuint texture)
+    {
+        // Bindings are per unit, so the unit has to be activated both to read and to restore the previous binding.
+        const GLenum activeTexture{m_state.GetActiveTexture()};
+        m_state.SetActiveTexture(unit);
+
+        const GLuint previous{m_state.GetTexture(target)};
+        if (previous != texture)
+        {
+            Save(StateType::Texture, (static_cast<uint64_t>(unit) << 32) | target, [unit, target, previous](StateShadow& state) {
+                state.SetActiveTexture(unit);
+                state.BindTexture(target, previous);
+            });
+            m_state.BindTexture(target, texture);
+        }
+
+        if (activeTexture != unit)
+        {
+            Save(StateType::ActiveTexture, 0, [activeTexture](StateShadow& state) { state.SetActiveTexture(activeTexture); });
+        }
+
+        m_state.SetActiveTexture(activeTexture);
+        return *this;
+    }
+
+    StateScope& StateScope::BindBuffer(GLenum target, GLuint buffer)
+    {
+        const GLuint previous{m_state.GetBuffer(target)};
+        if (previous != buffer)
+        {
+            Save(StateType::Buffer, target, [target, previous](StateShadow& state) { state.BindBuffer(target, previous); });
+            m_state.BindBuffer(target, buffer);
+        }
+
+        return *this;
+    }
+
+    StateScope& StateScope::BindVertexArray(GLuint vertexArray)
+    {
+        const GLuint previous{m_state.GetVertexArray()};
+        if (previous != vertexArray)
+        {
+            Save(StateType::VertexArray, 0, [previous](StateShadow& state) { state.BindVertexArray(previous); });
+            m_state.BindVertexArray(vertexArray);
+        }
+
+        return *this;
+    }
+
+    StateScope& StateScope::BindFramebuffer(GLenum target, GLuint framebuffer)
+    {
+        // GL_FRAMEBUFFER binds both, and each is restored separately since they may have differed.
+        if (target != GL_READ_FRAMEBUFFER)
+        {
+            const GLuint previous{m_state.GetFramebuffer(GL_DRAW_FRAMEBUFFER)};
+            if (previous != framebuffer)
+            {
+                Save(StateType::DrawFramebuffer, 0, [previous](StateShadow& state) { state.BindFramebuffer(GL_DRAW_FRAMEBUFFER, previous); });
+            }
+        }
+
+        if (target != GL_DRAW_FRAMEBUFFER)
+        {
+            const GLuint previous{m_state.GetFramebuffer(GL_READ_FRAMEBUFFER)};
+            if (previous != framebuffer)
+            {
+                Save(StateType::ReadFramebuffer, 0, [previous](StateShadow& state) { state.BindFramebuffer(GL_READ_FRAMEBUFFER, previous); });
+            }
+        }
+
+        m_state.BindFramebuffer(target, framebuffer);
+        return *this;
+    }
+
+    void StateScope::Save(StateType type, uint64_t target, std::function<void(StateShadow&)>&& restore)
+    {
+        // Only the first change is recorded, since that holds the value from before the scope.
+        auto it{std::find_if(m_saved.begin(), m_saved.end(), [type, target](const SavedState& saved) {
+            return saved.Type == type && saved.Target == target;
+        })};
+
+        if (it == m_saved.end())
+        {
+            m_saved.push_back({type, target, std::move(restore)});
+        }
+    }
+}
@@ -0,0 +1,530 @@
+#include <AndroidExtensions/StateShadow.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace android::OpenGLHelpers
+{
+    namespace
+    {
+        std::mutex g_shadowsMutex{};
+        std::unordered_map<EGLContext, std::unique_ptr<StateShadow>> g_shadows{};
+
+        // Bumped whenever a shadow is released, so threads do not keep using a cached pointer to it.
+        std::atomic<uint32_t> g_shadowsGeneration{};
+
+        struct ThreadState
+        {
+            std::optional<EGLBinding> Binding{};
+            EGLContext ShadowContext{EGL_NO_CONTEXT};
+            StateShadow* Shadow{};
+            uint32_t ShadowGeneration{};
+        };
+
+        thread_local ThreadState t_threadState{};
+
+        GLint GetInteger(GLenum name)
+        {
+            GLint value{};
+            glGetIntegerv(name, &value);
+            return value;
+        }
+
+        GLenum GetTextureBinding(GLenum target)
+        {
+            switch (target)
+            {
+                case GL_TEXTURE_2D:
+                    return GL_TEXTURE_BINDING_2D;
+                case GL_TEXTURE_3D:
+                    return GL_TEXTURE_BINDING_3D;
+                case GL_TEXTURE_2D_ARRAY:
+                    return GL_TEXTURE_BINDING_2D_ARRAY;
+                case GL_TEXTURE_CUBE_MAP:
+                    return GL_TEXTURE_BINDING_CUBE_MAP;
+                case GL_TEXTURE_EXTERNAL_OES:
+                    return GL_TEXTURE_BINDING_EXTERNAL_OES;
+                default:
+                    throw std::runtime_error{"Unsupported texture target"};
+            }
+        }
+
+        GLenum GetBufferBinding(GLenum target)
+        {
+            switch (target)
+            {
+                case GL_ARRAY_BUFFER:
+                    return GL_ARRAY_BUFFER_BINDING;
+                case GL_COPY_READ_BUFFER:
+                    return GL_COPY_READ_BUFFER_BINDING;
+                case GL_COPY_WRITE_BUFFER:
+                    return GL_COPY_WRITE_BUFFER_BINDING;
+                case GL_PIXEL_PACK_BUFFER:
+                    return GL_PIXEL_PACK_BUFFER_BINDING;
+                case GL_PIXEL_UNPACK_BUFFER:
+                    return GL_PIXEL_UNPACK_BUFFER_BINDING;
+                case GL_TRANSFORM_FEEDBACK_BUFFER:
+                    return GL_TRANSFORM_FEEDBACK_BUFFER_BINDING;
+                case GL_UNIFORM_BUFFER:
+                    return GL_UNIFORM_BUFFER_BINDING;
+                default:
+                    throw std::runtime_error{"Unsupported buffer target"};
+            }
+        }
+
+        Rect GetRect(GLenum name)
+        {
+            GLint values[4]{};
+            glGetIntegerv(name, values);
+            return {values[0], values[1], values[2], values[3]};
+        }
+
+        uint64_t GetTextureKey(GLenum unit, GLenum target)
+        {
+            return (static_cast<uint64_t>(unit) << 32) | target;
+        }
+    }
+
+    StateShadow& StateShadow::Current()
+    {
+        auto& threadState{t_threadState};
+        const EGLContext context{eglGetCurrentContext()};
+        if (context == EGL_NO_CONTEXT)
+        {
+            throw std::runtime_error{"No OpenGL ES context is current"};
+        }
+
+        const uint32_t generation{g_shadowsGeneration.load(std::memory_order_acquire)};
+        if (threadState.Shadow && threadState.ShadowContext == context && threadState.ShadowGeneration == generation)
+        {
+            return *threadState.Shadow;
+        }
+
+        std::lock_guard<std::mutex> guard{g_shadowsMutex};
+        auto& shadow{g_shadows[context]};
+        if (!shadow)
+        {
+            shadow = std::make_unique<StateShadow>();
+        }
+
+        threadState.ShadowContext = context;
+        threadState.Shadow = shadow.get();
+        threadState.ShadowGeneration = generation;
+        return *shadow;
+    }
+
+    void StateShadow::ContextDestroyed(EGLContext context)
+    {
+        std::lock_guard<std::mutex> guard{g_shadowsMutex};
+        if (g_shadows.erase(context) != 0)
+        {
+            g_shadowsGeneration.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    EGLBinding StateShadow::GetEGLBinding()
+    {
+        // Code that does not know about the tracked binding may call eglMakeCurrent itself, so the binding is only
+        // trusted while its context is still current. eglGetCurrentContext is a thread local lookup in EGL.
+        auto& binding{t_threadState.Binding};
+        const EGLContext context{eglGetCurrentContext()};
+        if (!binding || binding->Context != context)
+        {
+            binding = EGLBinding{eglGetCurrentDisplay(), eglGetCurrentSurface(EGL_DRAW), eglGetCurrentSurface(EGL_READ), context};
+        }
+
+        return *binding;
+    }
+
+    bool StateShadow::SetEGLBinding(const EGLBinding& binding)
+    {
+        if (GetEGLBinding() == binding)
+        {
+            return true;
+        }
+
+        // Releasing the current context still needs a valid display.
+        EGLDisplay display{binding.Display};
+        if (display == EGL_NO_DISPLAY)
+        {
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+
+        if (eglMakeCurrent(display, binding.DrawSurface, binding.ReadSurface, binding.Context) != EGL_TRUE)
+        {
+            t_threadState.Binding.reset();
+            return false;
+        }
+
+        t_threadState.Binding = binding;
+        return true;
+    }
+
+    void StateShadow::InvalidateEGLBinding()
+    {
+        t_threadState.Binding.reset();
+    }
+
+    void StateShadow::Invalidate()
+    {
+        m_capabilities.clear();
+        m_stencilWriteMask.reset();
+        m_blendFunc.reset();
+        m_depthWriteMask.reset();
+        m_depthFunc.reset();
+        m_viewport.reset();
+        m_scissor.reset();
+        m_program.reset();
+        m_activeTexture.reset();
+        m_textures.clear();
+        m_buffers.clear();
+        m_vertexArray.reset();
+        m_drawFramebuffer.reset();
+        m_readFramebuffer.reset();
+    }
+
+    bool StateShadow::IsEnabled(GLenum capability)
+    {
+        auto it{m_capabilities.find(capability)};
+        if (it == m_capabilities.end())
+        {
+            it = m_capabilities.emplace(capability, glIsEnabled(capability) == GL_TRUE).first;
+        }
+
+        return it->second;
+    }
+
+    void StateShadow::SetEnabled(GLenum capability, bool enabled)
+    {
+        auto it{m_capabilities.find(capability)};
+        if (it != m_capabilities.end() && it->second == enabled)
+        {
+            return;
+        }
+
+        if (enabled)
+        {
+            glEnable(capability);
+        }
+        else
+        {
+            glDisable(capability);
+        }
+
+        m_capabilities[capability] = enabled;
+    }
+
+    GLuint StateShadow::GetStencilWriteMask()
+    {
+        if (!m_stencilWriteMask)
+        {
+            m_stencilWriteMask = static_cast<GLuint>(GetInteger(GL_STENCIL_WRITEMASK));
+        }
+
+        return *m_stencilWriteMask;
+    }
+
+    void StateShadow::SetStencilWriteMask(GLuint mask)
+    {
+        if (m_stencilWriteMask != mask)
+        {
+            glStencilMask(mask);
+            m_stencilWriteMask = mask;
+        }
+    }
+
+    BlendFunc StateShadow::GetBlendFunc()
+    {
+        if (!m_blendFunc)
+        {
+            m_blendFunc = BlendFunc{
+                static_cast<GLenum>(GetInteger(GL_BLEND_SRC_RGB)),
+                static_cast<GLenum>(GetInteger(GL_BLEND_DST_RGB)),
+                static_cast<GLenum>(GetInteger(GL_BLEND_SRC_ALPHA)),
+                static_cast<GLenum>(GetInteger(GL_BLEND_DST_ALPHA)),
+            };
+        }
+
+        return *m_blendFunc;
+    }
+
+    void StateShadow::SetBlendFunc(const BlendFunc& blendFunc)
+    {
+        if (m_blendFunc != blendFunc)
+        {
+            glBlendFuncSeparate(blendFunc.SrcRGB, blendFunc.DstRGB, blendFunc.SrcAlpha, blendFunc.DstAlpha);
+            m_blendFunc = blendFunc;
+        }
+    }
+
+    bool StateShadow::GetDepthWriteMask()
+    {
+        if (!m_depthWriteMask)
+        {
+            GLboolean value{};
+            glGetBooleanv(GL_DEPTH_WRITEMASK, &value);
+            m_depthWriteMask = value == GL_TRUE;
+        }
+
+        return *m_depthWriteMask;
+    }
+
+    void StateShadow::SetDepthWriteMask(bool enabled)
+    {
+        if (m_depthWriteMask != enabled)
+        {
+            glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+            m_depthWriteMask = enabled;
+        }
+    }
+
+    GLenum StateShadow::GetDepthFunc()
+    {
+        if (!m_depthFunc)
+        {
+            m_depthFunc = static_cast<GLenum>(GetInteger(GL_DEPTH_FUNC));
+        }
+
+        return *m_depthFunc;
+    }
+
+    void StateShadow::SetDepthFunc(GLenum func)
+    {
+        if (m_depthFunc != func)
+        {
+            glDepthFunc(func);
+            m_depthFunc = func;
+        }
+    }
+
+    Rect StateShadow::GetViewport()
+    {
+        if (!m_viewport)
+        {
+            m_viewport = GetRect(GL_VIEWPORT);
+        }
+
+        return *m_viewport;
+    }
+
+    void StateShadow::SetViewport(const Rect& viewport)
+    {
+        if (m_viewport != viewport)
+        {
+            glViewport(viewport.X, viewport.Y, viewport.Width, viewport.Height);
+            m_viewport = viewport;
+        }
+    }
+
+    Rect StateShadow::GetScissor()
+    {
+        if (!m_scissor)
+        {
+            m_scissor = GetRect(GL_SCISSOR_BOX);
+        }
+
+        return *m_scissor;
+    }
+
+    void StateShadow::SetScissor(const Rect& scissor)
+    {
+        if (m_scissor != scissor)
+        {
+            glScissor(scissor.X, scissor.Y, scissor.Width, scissor.Height);
+            m_scissor = scissor;
+        }
+    }
+
+    GLuint StateShadow::GetProgram()
+    {
+        if (!m_program)
+        {
+            m_program = static_cast<GLuint>(GetInteger(GL_CURRENT_PROGRAM));
+        }
+
+        return *m_program;
+    }
+
+    void StateShadow::UseProgram(GLuint program)
+    {
+        if (m_program != program)
+        {
+            glUseProgram(program);
+            m_program = program;
+        }
+    }
+
+    GLenum StateShadow::GetActiveTexture()
+    {
+        if (!m_activeTexture)
+        {
+            m_activeTexture = static_cast<GLenum>(GetInteger(GL_ACTIVE_TEXTURE));
+        }
+
+        return *m_activeTexture;
+    }
+
+    void StateShadow::SetActiveTexture(GLenum unit)
+    {
+        if (m_activeTexture != unit)
+        {
+            glActiveTexture(unit);
+            m_activeTexture = unit;
+        }
+    }
+
+    GLuint StateShadow::GetTexture(GLenum target)
+    {
+        const uint64_t key{GetTextureKey(GetActiveTexture(), target)};
+        auto it{m_textures.find(key)};
+        if (it == m_textures.end())
+        {
+            it = m_textures.emplace(key, static_cast<GLuint>(GetInteger(GetTextureBinding(target)))).first;
+        }
+
+        return it->second;
+    }
+
+    void StateShadow::BindTexture(GLenum target, GLuint texture)
+    {
+        const uint64_t key{GetTextureKey(GetActiveTexture(), target)};
+        auto it{m_textures.find(key)};
+        if (it != m_textures.end() && it->second == texture)
+        {
+            return;
+        }
+
+        glBindTexture(target, texture);
+        m_textures[key] = texture;
+    }
+
+    GLuint StateShadow::GetBuffer(GLenum target)
+    {
+        auto it{m_buffers.find(target)};
+        if (it == m_buffers.end())
+        {
+            it = m_buffers.emplace(target, static_cast<GLuint>(GetInteger(GetBufferBinding(target)))).first;
+        }
+
+        return it->second;
+    }
+
+    void StateShadow::BindBuffer(GLenum target, GLuint buffer)
+    {
+        auto it{m_buffers.find(target)};
+        if (it != m_buffers.end() && it->second == buffer)
+        {
+            return;
+        }
+
+        glBindBuffer(target, buffer);
+        m_buffers[target] = buffer;
+    }
+
+    GLuint StateShadow::GetVertexArray()
+    {
+        if (!m_vertexArray)
+        {
+            m_vertexArray = static_cast<GLuint>(GetInteger(GL_VERTEX_ARRAY_BINDING));
+        }
+
+        return *m_vertexArray;
+    }
+
+    void StateShadow::BindVertexArray(GLuint vertexArray)
+    {
+        if (m_vertexArray != vertexArray)
+        {
+            glBindVertexArray(vertexArray);
+            m_vertexArray = vertexArray;
+        }
+    }
+
+    GLuint StateShadow::GetFramebuffer(GLenum target)
+    {
+        if (target == GL_READ_FRAMEBUFFER)
+        {
+            if (!m_readFramebuffer)
+            {
+                m_readFramebuffer = static_cast<GLuint>(GetInteger(GL_READ_FRAMEBUFFER_BINDING));
+            }
+
+            return *m_readFramebuffer;
+        }
+
+        if (!m_drawFramebuffer)
+        {
+            m_drawFramebuffer = static_cast<GLuint>(GetInteger(GL_DRAW_FRAMEBUFFER_BINDING));
+        }
+
+        return *m_drawFramebuffer;
+    }
+
+    void StateShadow::BindFramebuffer(GLenum target, GLuint framebuffer)
+    {
+        const bool draw{target != GL_READ_FRAMEBUFFER};
+        const bool read{target != GL_DRAW_FRAMEBUFFER};
+        if ((!draw || m_drawFramebuffer == framebuffer) && (!read || m_readFramebuffer == framebuffer))
+        {
+            return;
+        }
+
+        glBindFramebuffer(target, framebuffer);
+        if (draw)
+        {
+            m_drawFramebuffer = framebuffer;
+        }
+
+        if (read)
+        {
+            m_readFramebuffer = framebuffer;
+        }
+    }
+
+    void StateShadow::DeleteTextures(GLsizei count, const GLuint* textures)
+    {
+        glDeleteTextures(count, textures);
+        for (auto& [key, texture] : m_textures)
+        {
+            if (std::find(textures, textures + count, texture) != textures + count)
+            {
+                texture = 0;
+            }
+        }
+    }
+
+    void StateShadow::DeleteBuffers(GLsizei count, const GLuint* buffers)
+    {
+        glDeleteBuffers(count, buffers);
+        for (auto& [target, buffer] : m_buffers)
+        {
+            if (std::find(buffers, buffers + count, buffer) != buffers + count)
+            {
+                buffer = 0;
+            }
+        }
+    }
+
+    void StateShadow::DeleteFramebuffers(GLsizei count, const GLuint* framebuffers)
+    {
+        glDeleteFramebuffers(count, framebuffers);
+        for (auto* binding : {&m_drawFramebuffer, &m_readFramebuffer})
+        {
+            if (*binding && std::find(framebuffers, framebuffers + count, **binding) != framebuffers + count)
+            {
+                *binding = 0;
+            }
+        }
+    }
+
+    void StateShadow::DeleteVertexArrays(GLsizei count, const GLuint* vertexArrays)
+    {
+        glDeleteVertexArrays(count, vertexArrays);
+        if (m_vertexArray && std::find(vertexArrays, vertexArrays + count, *m_vertexArray) != vertexArrays + count)
+        {
+            m_vertexArray = 0;
+        }
+    }
+}
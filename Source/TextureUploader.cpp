@@ -0,0 +1,310 @@
+#include <AndroidExtensions/TextureUploader.h>
+#include <AndroidExtensions/StateScope.h>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+namespace android::OpenGLHelpers
+{
+    namespace
+    {
+        // Staged rows start at offsets aligned for any pixel type.
+        constexpr size_t STAGING_ALIGNMENT{16};
+
+        // Unpack state that changes how rows are read from the staging buffer. Rows are staged tightly packed, so
+        // these are reset while uploading; the alignment is set to 1 and everything else to 0.
+        constexpr GLenum UNPACK_PARAMETERS[]{
+            GL_UNPACK_ALIGNMENT,
+            GL_UNPACK_ROW_LENGTH,
+            GL_UNPACK_SKIP_ROWS,
+            GL_UNPACK_SKIP_PIXELS,
+            GL_UNPACK_IMAGE_HEIGHT,
+            GL_UNPACK_SKIP_IMAGES,
+        };
+
+        size_t GetComponentCount(GLenum format)
+        {
+            switch (format)
+            {
+                case GL_RED:
+                case GL_RED_INTEGER:
+                case GL_ALPHA:
+                case GL_LUMINANCE:
+                case GL_DEPTH_COMPONENT:
+                    return 1;
+                case GL_RG:
+                case GL_RG_INTEGER:
+                case GL_LUMINANCE_ALPHA:
+                case GL_DEPTH_STENCIL:
+                    return 2;
+                case GL_RGB:
+                case GL_RGB_INTEGER:
+                    return 3;
+                default:
+                    return 4;
+            }
+        }
+
+        size_t GetBytesPerPixel(GLenum format, GLenum type)
+        {
+            switch (type)
+            {
+                case GL_UNSIGNED_SHORT_5_6_5:
+                case GL_UNSIGNED_SHORT_4_4_4_4:
+                case GL_UNSIGNED_SHORT_5_5_5_1:
+                    return 2;
+                case GL_UNSIGNED_INT_2_10_10_10_REV:
+                case GL_UNSIGNED_INT_10F_11F_11F_REV:
+                case GL_UNSIGNED_INT_5_9_9_9_REV:
+                case GL_UNSIGNED_INT_24_8:
+                    return 4;
+                case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+                    return 8;
+                case GL_UNSIGNED_SHORT:
+                case GL_SHORT:
+                case GL_HALF_FLOAT:
+                    return GetComponentCount(format) * 2;
+                case GL_UNSIGNED_INT:
+                case GL_INT:
+                case GL_FLOAT:
+                    return GetComponentCount(format) * 4;
+                default:
+                    return GetComponentCount(format);
+            }
+        }
+
+        size_t AlignUp(size_t value, size_t alignment)
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+    }
+
+    struct TextureUploader::Upload final
+    {
+        GLuint Texture;
+        GLint Level;
+        GLint X;
+        GLint Y;
+        GLsizei Width;
+        GLsizei Height;
+        GLenum Format;
+        GLenum Type;
+        std::vector<std::byte> Pixels;
+        size_t RowBytes;
+        GLsizei NextRow;
+        arcana::task_completion_source<void, std::exception_ptr> Tcs;
+    };
+
+    TextureUploader::TextureUploader(size_t bytesPerFrame, size_t stagingBufferSize, size_t stagingBufferCount)
+        : m_bytesPerFrame{bytesPerFrame}
+        , m_stagingBufferSize{stagingBufferSize}
+        , m_stagingBuffers(stagingBufferCount)
+    {
+        if (stagingBufferCount == 0)
+        {
+            throw std::invalid_argument{"TextureUploader requires at least one staging buffer"};
+        }
+
+        // The buffers are allocated once and reused for the lifetime of the uploader.
+        GLTransactions::StateScope scope{};
+        for (auto& stagingBuffer : m_stagingBuffers)
+        {
+            glGenBuffers(1, &stagingBuffer.Buffer);
+            scope.BindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingBuffer.Buffer);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(m_stagingBufferSize), nullptr, GL_STREAM_DRAW);
+        }
+    }
+
+    TextureUploader::~TextureUploader()
+    {
+        auto error{std::make_exception_ptr(std::runtime_error{"Texture upload was cancelled"})};
+        for (auto& upload : m_queue)
+        {
+            upload->Tcs.complete(arcana::make_unexpected(error));
+        }
+
+        // Uploads whose rows were all issued will still land, but whether they did can no longer be observed.
+        for (auto& stagingBuffer : m_stagingBuffers)
+        {
+            for (auto& upload : stagingBuffer.Completing)
+            {
+                upload->Tcs.complete(arcana::make_unexpected(error));
+            }
+
+            StateShadow::Current().DeleteBuffers(1, &stagingBuffer.Buffer);
+        }
+    }
+
+    arcana::task<void, std::exception_ptr> TextureUploader::UploadAsync(GLuint texture, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+        GLenum format, GLenum type, std::vector<std::byte> pixels)
+    {
+        if (width <= 0 || height <= 0)
+        {
+            throw std::invalid_argument{"Texture upload region must not be empty"};
+        }
+
+        const size_t rowBytes{static_cast<size_t>(width) * GetBytesPerPixel(format, type)};
+        if (rowBytes > m_stagingBufferSize)
+        {
+            throw std::invalid_argument{"Texture rows do not fit into a staging buffer"};
+        }
+
+        if (pixels.size() < rowBytes * static_cast<size_t>(height))
+        {
+            throw std::invalid_argument{"Not enough pixel data for the texture region"};
+        }
+
+        m_queue.push_back(std::make_unique<Upload>(Upload{texture, level, x, y, width, height, format, type, std::move(pixels), rowBytes, 0, {}}));
+        return m_queue.back()->Tcs.as_task();
+    }
+
+    void TextureUploader::ProcessFrame()
+    {
+        CompleteSignaledBuffers();
+
+        if (m_queue.empty())
+        {
+            return;
+        }
+
+        // The unpack state is not shadowed, so it is queried once per frame that uploads anything.
+        GLint previousUnpack[std::size(UNPACK_PARAMETERS)]{};
+        for (size_t index = 0; index < std::size(UNPACK_PARAMETERS); ++index)
+        {
+            glGetIntegerv(UNPACK_PARAMETERS[index], &previousUnpack[index]);
+            glPixelStorei(UNPACK_PARAMETERS[index], UNPACK_PARAMETERS[index] == GL_UNPACK_ALIGNMENT ? 1 : 0);
+        }
+
+        GLTransactions::StateScope scope{};
+        StateShadow& state{StateShadow::Current()};
+        const GLenum textureUnit{state.GetActiveTexture()};
+
+        size_t budget{m_bytesPerFrame};
+        bool issued{};
+        while (!m_queue.empty())
+        {
+            auto& stagingBuffer{m_stagingBuffers[m_nextStagingBuffer]};
+            if (stagingBuffer.Fence)
+            {
+                // Every staging buffer is still in use by the GPU.
+                break;
+            }
+
+            // At least one row is issued per frame, so uploads make progress even with a tiny budget.
+            const size_t capacity{issued ? std::min(budget, m_stagingBufferSize) : std::max(std::min(budget, m_stagingBufferSize), m_queue.front()->RowBytes)};
+            if (capacity < m_queue.front()->RowBytes)
+            {
+                break;
+            }
+
+            scope.BindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingBuffer.Buffer);
+
+            // The fence guarantees the GPU is done with the buffer, so the previous contents can be discarded without
+            // synchronizing.
+            auto* mapped{static_cast<std::byte*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(capacity),
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT))};
+            if (!mapped)
+            {
+                break;
+            }
+
+            // Several uploads can share one staging buffer; each is copied first and issued after unmapping.
+            struct Chunk
+            {
+                Upload* Source;
+                size_t Offset;
+                GLsizei FirstRow;
+                GLsizei RowCount;
+            };
+
+            std::vector<Chunk> chunks{};
+            size_t offset{};
+            for (auto it = m_queue.begin(); it != m_queue.end(); ++it)
+            {
+                Upload& upload{**it};
+                offset = AlignUp(offset, STAGING_ALIGNMENT);
+                if (offset >= capacity)
+                {
+                    break;
+                }
+
+                const auto rowCount{static_cast<GLsizei>(std::min<size_t>((capacity - offset) / upload.RowBytes, static_cast<size_t>(upload.Height - upload.NextRow)))};
+                if (rowCount == 0)
+                {
+                    break;
+                }
+
+                std::memcpy(mapped + offset, upload.Pixels.data() + static_cast<size_t>(upload.NextRow) * upload.RowBytes, static_cast<size_t>(rowCount) * upload.RowBytes);
+                chunks.push_back({&upload, offset, upload.NextRow, rowCount});
+                upload.NextRow += rowCount;
+                offset += static_cast<size_t>(rowCount) * upload.RowBytes;
+
+                if (upload.NextRow < upload.Height)
+                {
+                    break;
+                }
+            }
+
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+            for (const auto& chunk : chunks)
+            {
+                const Upload& upload{*chunk.Source};
+                scope.BindTexture(textureUnit, GL_TEXTURE_2D, upload.Texture);
+                glTexSubImage2D(GL_TEXTURE_2D, upload.Level, upload.X, upload.Y + chunk.FirstRow, upload.Width, chunk.RowCount, upload.Format, upload.Type,
+                    reinterpret_cast<const void*>(chunk.Offset));
+                m_bytesUploaded += static_cast<size_t>(chunk.RowCount) * upload.RowBytes;
+            }
+
+            stagingBuffer.Fence = Fence::Insert();
+            while (!m_queue.empty() && m_queue.front()->NextRow == m_queue.front()->Height)
+            {
+                stagingBuffer.Completing.push_back(std::move(m_queue.front()));
+                m_queue.pop_front();
+            }
+
+            budget -= std::min(budget, offset);
+            issued = true;
+            m_nextStagingBuffer = (m_nextStagingBuffer + 1) % m_stagingBuffers.size();
+        }
+
+        for (size_t index = 0; index < std::size(UNPACK_PARAMETERS); ++index)
+        {
+            glPixelStorei(UNPACK_PARAMETERS[index], previousUnpack[index]);
+        }
+    }
+
+    TextureUploader::Statistics TextureUploader::GetStatistics() const
+    {
+        size_t pending{m_queue.size()};
+        for (const auto& stagingBuffer : m_stagingBuffers)
+        {
+            pending += stagingBuffer.Completing.size();
+        }
+
+        return {pending, m_completedUploads, m_bytesUploaded};
+    }
+
+    void TextureUploader::CompleteSignaledBuffers()
+    {
+        for (auto& stagingBuffer : m_stagingBuffers)
+        {
+            if (!stagingBuffer.Fence || !stagingBuffer.Fence.IsSignaled())
+            {
+                continue;
+            }
+
+            stagingBuffer.Fence = {};
+
+            // Moved out first, since continuations may queue new uploads.
+            auto completing{std::move(stagingBuffer.Completing)};
+            stagingBuffer.Completing.clear();
+            for (auto& upload : completing)
+            {
+                ++m_completedUploads;
+                upload->Tcs.complete();
+            }
+        }
+    }
+}
@@ -0,0 +1,389 @@
+#include <AndroidExtensions/UriParser.h>
+#include <AndroidExtensions/Globals.h>
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+namespace android::net
+{
+    namespace
+    {
+        bool IsAlpha(char c)
+        {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+        }
+
+        bool IsDigit(char c)
+        {
+            return c >= '0' && c <= '9';
+        }
+
+        int HexValue(char c)
+        {
+            if (IsDigit(c))
+            {
+                return c - '0';
+            }
+
+            if (c >= 'a' && c <= 'f')
+            {
+                return c - 'a' + 10;
+            }
+
+            if (c >= 'A' && c <= 'F')
+            {
+                return c - 'A' + 10;
+            }
+
+            return -1;
+        }
+
+        bool IsSchemeCharacter(char c)
+        {
+            return IsAlpha(c) || IsDigit(c) || c == '+' || c == '-' || c == '.';
+        }
+
+        // java.net.URI accepts any character outside of US-ASCII, but none of the ASCII control characters, the space
+        // or the characters RFC 2396 lists as unwise.
+        bool IsLegalCharacter(char c)
+        {
+            const auto value{static_cast<unsigned char>(c)};
+            if (value >= 0x80)
+            {
+                return true;
+            }
+
+            if (value <= 0x20 || value == 0x7F)
+            {
+                return false;
+            }
+
+            switch (c)
+            {
+                case '"':
+                case '<':
+                case '>':
+                case '\\':
+                case '^':
+                case '`':
+                case '{':
+                case '|':
+                case '}':
+                    return false;
+                default:
+                    return true;
+            }
+        }
+
+        bool HasValidCharacters(std::string_view uri)
+        {
+            for (size_t index = 0; index < uri.size(); ++index)
+            {
+                if (uri[index] == '%')
+                {
+                    if (index + 2 >= uri.size() || HexValue(uri[index + 1]) < 0 || HexValue(uri[index + 2]) < 0)
+                    {
+                        return false;
+                    }
+
+                    index += 2;
+                }
+                else if (!IsLegalCharacter(uri[index]))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        bool ParseAuthority(std::string_view authority, UriComponents& components)
+        {
+            components.Authority = authority;
+
+            const size_t userInfoEnd{authority.rfind('@')};
+            if (userInfoEnd != std::string_view::npos)
+            {
+                components.UserInfo = authority.substr(0, userInfoEnd);
+                authority.remove_prefix(userInfoEnd + 1);
+            }
+
+            size_t hostEnd{};
+            if (!authority.empty() && authority.front() == '[')
+            {
+                hostEnd = authority.find(']');
+                if (hostEnd == std::string_view::npos)
+                {
+                    return false;
+                }
+
+                ++hostEnd;
+            }
+            else
+            {
+                hostEnd = std::min(authority.find(':'), authority.size());
+            }
+
+            components.Host = authority.substr(0, hostEnd);
+            authority.remove_prefix(hostEnd);
+
+            if (authority.empty())
+            {
+                return true;
+            }
+
+            if (authority.front() != ':')
+            {
+                return false;
+            }
+
+            // An empty port is legal and means the scheme's default, like a missing one.
+            const std::string_view port{authority.substr(1)};
+            if (port.empty())
+            {
+                return true;
+            }
+
+            int64_t value{};
+            for (char c : port)
+            {
+                if (!IsDigit(c))
+                {
+                    return false;
+                }
+
+                value = value * 10 + (c - '0');
+                if (value > INT32_MAX)
+                {
+                    return false;
+                }
+            }
+
+            components.Port = static_cast<int32_t>(value);
+            return true;
+        }
+    }
+
+    std::optional<UriComponents> ParseUri(std::string_view uri)
+    {
+        if (!HasValidCharacters(uri))
+        {
+            return {};
+        }
+
+        UriComponents components{};
+        std::string_view rest{uri};
+
+        // The fragment is split off first, since it is allowed in opaque URIs too.
+        const size_t fragmentStart{rest.find('#')};
+        if (fragmentStart != std::string_view::npos)
+        {
+            components.Fragment = rest.substr(fragmentStart + 1);
+            rest = rest.substr(0, fragmentStart);
+        }
+
+        // A colon only ends a scheme if it comes before any of the other delimiters.
+        const size_t schemeEnd{rest.find_first_of(":/?")};
+        if (schemeEnd != std::string_view::npos && rest[schemeEnd] == ':')
+        {
+            const std::string_view scheme{rest.substr(0, schemeEnd)};
+            if (scheme.empty() || !IsAlpha(scheme.front()))
+            {
+                return {};
+            }
+
+            for (char c : scheme)
+            {
+                if (!IsSchemeCharacter(c))
+                {
+                    return {};
+                }
+            }
+
+            components.Scheme = scheme;
+            rest.remove_prefix(schemeEnd + 1);
+
+            if (rest.empty())
+            {
+                return {};
+            }
+
+            if (rest.front() != '/')
+            {
+                components.Opaque = true;
+                components.Path = rest;
+                return components;
+            }
+        }
+
+        const size_t queryStart{rest.find('?')};
+        if (queryStart != std::string_view::npos)
+        {
+            components.Query = rest.substr(queryStart + 1);
+            rest = rest.substr(0, queryStart);
+        }
+
+        if (rest.substr(0, 2) == "//")
+        {
+            rest.remove_prefix(2);
+            const size_t authorityEnd{std::min(rest.find('/'), rest.size())};
+            if (!ParseAuthority(rest.substr(0, authorityEnd), components))
+            {
+                return {};
+            }
+
+            rest.remove_prefix(authorityEnd);
+        }
+
+        components.Path = rest;
+        return components;
+    }
+
+    std::string DecodeUriComponent(std::string_view component)
+    {
+        std::string result{};
+        result.reserve(component.size());
+
+        for (size_t index = 0; index < component.size(); ++index)
+        {
+            if (component[index] == '%' && index + 2 < component.size() && HexValue(component[index + 1]) >= 0 && HexValue(component[index + 2]) >= 0)
+            {
+                result.push_back(static_cast<char>(HexValue(component[index + 1]) * 16 + HexValue(component[index + 2])));
+                index += 2;
+            }
+            else
+            {
+                result.push_back(component[index]);
+            }
+        }
+
+        return result;
+    }
+
+    struct ParsedUri::State final
+    {
+        State(std::string uri)
+            : Uri{std::move(uri)}
+        {
+        }
+
+        ~State()
+        {
+            if (JavaUri || JavaURL)
+            {
+                JNIEnv* env{global::GetEnvForCurrentThread()};
+                if (JavaUri)
+                {
+                    env->DeleteGlobalRef(JavaUri);
+                }
+
+                if (JavaURL)
+                {
+                    env->DeleteGlobalRef(JavaURL);
+                }
+            }
+        }
+
+        // Components point into Uri, which is never modified after parsing.
+        const std::string Uri;
+        UriComponents Components{};
+
+        std::once_flag JavaUriFlag{};
+        jobject JavaUri{};
+
+        std::once_flag JavaURLFlag{};
+        jobject JavaURL{};
+    };
+
+    ParsedUri::ParsedUri(std::string uri)
+        : m_state{std::make_shared<State>(std::move(uri))}
+    {
+        auto components{ParseUri(m_state->Uri)};
+        if (!components)
+        {
+            throw std::runtime_error{"Invalid URI: " + m_state->Uri};
+        }
+
+        m_state->Components = *components;
+    }
+
+    const std::string& ParsedUri::ToString() const
+    {
+        return m_state->Uri;
+    }
+
+    std::string_view ParsedUri::Scheme() const
+    {
+        return m_state->Components.Scheme;
+    }
+
+    std::string_view ParsedUri::Authority() const
+    {
+        return m_state->Components.Authority;
+    }
+
+    std::string_view ParsedUri::UserInfo() const
+    {
+        return m_state->Components.UserInfo;
+    }
+
+    std::string_view ParsedUri::Host() const
+    {
+        return m_state->Components.Host;
+    }
+
+    int32_t ParsedUri::Port() const
+    {
+        return m_state->Components.Port;
+    }
+
+    std::string_view ParsedUri::Path() const
+    {
+        return m_state->Components.Path;
+    }
+
+    std::string_view ParsedUri::Query() const
+    {
+        return m_state->Components.Query;
+    }
+
+    std::string_view ParsedUri::Fragment() const
+    {
+        return m_state->Components.Fragment;
+    }
+
+    bool ParsedUri::IsAbsolute() const
+    {
+        return !m_state->Components.Scheme.empty();
+    }
+
+    bool ParsedUri::IsOpaque() const
+    {
+        return m_state->Components.Opaque;
+    }
+
+    std::string ParsedUri::DecodedPath() const
+    {
+        return DecodeUriComponent(m_state->Components.Path);
+    }
+
+    Uri ParsedUri::ToUri() const
+    {
+        std::call_once(m_state->JavaUriFlag, [this]() {
+            Uri uri{Uri::Parse(m_state->Uri.c_str())};
+            m_state->JavaUri = global::GetEnvForCurrentThread()->NewGlobalRef(uri);
+        });
+
+        return {m_state->JavaUri};
+    }
+
+    java::net::URL ParsedUri::ToURL() const
+    {
+        std::call_once(m_state->JavaURLFlag, [this]() {
+            java::net::URL url{java::lang::String{m_state->Uri.c_str()}};
+            m_state->JavaURL = global::GetEnvForCurrentThread()->NewGlobalRef(url);
+        });
+
+        return {m_state->JavaURL};
+    }
+}
@@ -0,0 +1,169 @@
+#include <AndroidExtensions/AssetArchiveFormat.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace android::Assets;
+
+namespace
+{
+    struct InputFile
+    {
+        std::string Path;
+        std::vector<std::byte> Data;
+        std::vector<std::byte> Compressed;
+    };
+
+    std::vector<std::byte> ReadFile(const fs::path& path)
+    {
+        std::ifstream stream{path, std::ios::binary};
+        std::vector<std::byte> data(static_cast<size_t>(fs::file_size(path)));
+        stream.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!stream)
+        {
+            throw std::runtime_error{"Failed to read " + path.string()};
+        }
+
+        return data;
+    }
+
+    uint64_t Align(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    void Write(std::ofstream& stream, const void* data, size_t size)
+    {
+        stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    }
+
+    int Usage()
+    {
+        std::cerr << "Usage: AssetPacker <input directory> <output archive> [--alignment <bytes>] [--store]" << std::endl;
+        return 1;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        return Usage();
+    }
+
+    const fs::path inputDirectory{argv[1]};
+    const fs::path outputPath{argv[2]};
+    uint32_t alignment{16};
+    bool compress{true};
+
+    for (int index = 3; index < argc; ++index)
+    {
+        if (std::strcmp(argv[index], "--alignment") == 0 && index + 1 < argc)
+        {
+            alignment = static_cast<uint32_t>(std::stoul(argv[++index]));
+        }
+        else if (std::strcmp(argv[index], "--store") == 0)
+        {
+            compress = false;
+        }
+        else
+        {
+            return Usage();
+        }
+    }
+
+    if (alignment == 0 || alignment % alignof(Archive::EntryRecord) != 0)
+    {
+        std::cerr << "Alignment must be a non-zero multiple of " << alignof(Archive::EntryRecord) << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        std::vector<InputFile> files{};
+        for (const auto& entry : fs::recursive_directory_iterator{inputDirectory})
+        {
+            if (entry.is_regular_file())
+            {
+                files.push_back({fs::relative(entry.path(), inputDirectory).generic_string(), ReadFile(entry.path()), {}});
+            }
+        }
+
+        // The reader binary searches the entry table, so entries are sorted bytewise by path.
+        std::sort(files.begin(), files.end(), [](const InputFile& left, const InputFile& right) { return left.Path < right.Path; });
+
+        Archive::Header header{};
+        header.Magic = Archive::MAGIC;
+        header.Version = Archive::VERSION;
+        header.EntryCount = static_cast<uint32_t>(files.size());
+        header.Alignment = alignment;
+        header.EntryTableOffset = sizeof(Archive::Header);
+        header.PathTableOffset = header.EntryTableOffset + files.size() * sizeof(Archive::EntryRecord);
+
+        std::string pathTable{};
+        std::vector<Archive::EntryRecord> records{};
+        for (auto& file : files)
+        {
+            Archive::EntryRecord record{};
+            record.PathOffset = static_cast<uint32_t>(pathTable.size());
+            record.PathLength = static_cast<uint32_t>(file.Path.size());
+            record.Size = file.Data.size();
+            record.Checksum = Archive::Crc32(file.Data.data(), file.Data.size());
+
+            if (compress)
+            {
+                file.Compressed = Archive::CompressLZ4(file.Data.data(), file.Data.size());
+            }
+
+            record.Compression = file.Compressed.empty() ? Archive::Compression::None : Archive::Compression::LZ4;
+            record.StoredSize = file.Compressed.empty() ? file.Data.size() : file.Compressed.size();
+
+            pathTable += file.Path;
+            records.push_back(record);
+        }
+
+        uint64_t offset{Align(header.PathTableOffset + pathTable.size(), alignment)};
+        for (auto& record : records)
+        {
+            record.DataOffset = offset;
+            offset = Align(offset + record.StoredSize, alignment);
+        }
+
+        std::ofstream stream{outputPath, std::ios::binary | std::ios::trunc};
+        Write(stream, &header, sizeof(header));
+        Write(stream, records.data(), records.size() * sizeof(Archive::EntryRecord));
+        Write(stream, pathTable.data(), pathTable.size());
+
+        uint64_t position{header.PathTableOffset + pathTable.size()};
+        uint64_t storedBytes{};
+        const std::vector<char> padding(alignment);
+        for (size_t index = 0; index < files.size(); ++index)
+        {
+            Write(stream, padding.data(), static_cast<size_t>(records[index].DataOffset - position));
+
+            const auto& data{files[index].Compressed.empty() ? files[index].Data : files[index].Compressed};
+            Write(stream, data.data(), data.size());
+            position = records[index].DataOffset + data.size();
+            storedBytes += data.size();
+        }
+
+        if (!stream)
+        {
+            throw std::runtime_error{"Failed to write " + outputPath.string()};
+        }
+
+        std::cout << "Packed " << files.size() << " files (" << storedBytes << " bytes stored) into " << outputPath.string() << std::endl;
+        return 0;
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+}
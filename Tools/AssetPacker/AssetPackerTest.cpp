@@ -0,0 +1,158 @@
+#include <AndroidExtensions/AssetArchiveFormat.h>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace android::Assets;
+
+// Packs a directory with the AssetPacker executable, then reads the archive back and checks that every file
+// round trips with a valid checksum, both compressed and stored.
+//
+// Usage: AssetPackerTest <AssetPacker executable> <scratch directory>
+namespace
+{
+    void Check(bool condition, const std::string& message)
+    {
+        if (!condition)
+        {
+            throw std::runtime_error{message};
+        }
+    }
+
+    std::vector<std::byte> ReadFile(const fs::path& path)
+    {
+        std::ifstream stream{path, std::ios::binary};
+        std::vector<std::byte> data(static_cast<size_t>(fs::file_size(path)));
+        stream.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        Check(static_cast<bool>(stream), "Failed to read " + path.string());
+        return data;
+    }
+
+    void WriteFile(const fs::path& path, const std::vector<std::byte>& data)
+    {
+        fs::create_directories(path.parent_path());
+        std::ofstream stream{path, std::ios::binary | std::ios::trunc};
+        stream.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        Check(static_cast<bool>(stream), "Failed to write " + path.string());
+    }
+
+    // Covers empty files, data that does not compress, and data whose LZ4 encoding has long literal and match runs.
+    std::map<std::string, std::vector<std::byte>> CreateInputs()
+    {
+        std::map<std::string, std::vector<std::byte>> inputs{};
+        inputs["empty.bin"] = {};
+
+        std::mt19937 random{1234};
+        std::vector<std::byte> noise(70000);
+        for (auto& value : noise)
+        {
+            value = static_cast<std::byte>(random());
+        }
+        inputs["noise.bin"] = noise;
+
+        std::vector<std::byte> repeated(300000, std::byte{'a'});
+        inputs["repeated.bin"] = repeated;
+
+        std::string text{};
+        for (int line = 0; line < 5000; ++line)
+        {
+            text += "line " + std::to_string(line % 97) + " of some shader source\n";
+        }
+        inputs["shaders/lit.glsl"] = {reinterpret_cast<const std::byte*>(text.data()), reinterpret_cast<const std::byte*>(text.data() + text.size())};
+
+        // Random runs between repeats, so sequences alternate between literals and matches.
+        std::vector<std::byte> mixed{};
+        for (int block = 0; block < 200; ++block)
+        {
+            mixed.insert(mixed.end(), noise.begin() + block * 7, noise.begin() + block * 7 + block % 40);
+            mixed.insert(mixed.end(), static_cast<size_t>(block % 23 + 4), static_cast<std::byte>(block));
+        }
+        inputs["textures/mixed.bin"] = mixed;
+
+        return inputs;
+    }
+
+    void VerifyArchive(const fs::path& archivePath, const std::map<std::string, std::vector<std::byte>>& inputs, bool compressed)
+    {
+        const auto archive{ReadFile(archivePath)};
+        Archive::Reader reader{archive.data(), archive.size()};
+        Check(reader.EntryCount() == inputs.size(), "Unexpected entry count in " + archivePath.string());
+
+        bool anyCompressed{};
+        for (const auto& [path, data] : inputs)
+        {
+            const auto entry{reader.Find(path)};
+            Check(entry.has_value(), "Missing entry " + path);
+            Check(entry->Size == data.size(), "Unexpected size for " + path);
+            Check(Archive::Reader::VerifyChecksum(*entry), "Checksum mismatch for " + path);
+
+            std::vector<std::byte> extracted(static_cast<size_t>(entry->Size));
+            Archive::Reader::Extract(*entry, extracted.data());
+            Check(extracted == data, "Contents differ for " + path);
+
+            anyCompressed |= entry->Compression == Archive::Compression::LZ4;
+        }
+
+        Check(anyCompressed == compressed, "Unexpected compression in " + archivePath.string());
+        Check(!reader.Find("missing.bin").has_value(), "Found an entry that was never packed");
+    }
+
+    void Pack(const fs::path& packer, const fs::path& input, const fs::path& output, const std::string& options)
+    {
+        const std::string command{"\"" + packer.string() + "\" \"" + input.string() + "\" \"" + output.string() + "\"" + options};
+        Check(std::system(command.c_str()) == 0, "AssetPacker failed: " + command);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: AssetPackerTest <AssetPacker executable> <scratch directory>" << std::endl;
+        return 1;
+    }
+
+    const fs::path packer{argv[1]};
+    const fs::path scratch{argv[2]};
+
+    try
+    {
+        fs::remove_all(scratch);
+        const auto inputs{CreateInputs()};
+        for (const auto& [path, data] : inputs)
+        {
+            WriteFile(scratch / "input" / path, data);
+        }
+
+        Pack(packer, scratch / "input", scratch / "compressed.axar", "");
+        VerifyArchive(scratch / "compressed.axar", inputs, true);
+
+        Pack(packer, scratch / "input", scratch / "stored.axar", " --store --alignment 4096");
+        VerifyArchive(scratch / "stored.axar", inputs, false);
+
+        // Sequences without literals copy nothing before their match, including when the output is still empty.
+        const std::byte matchOnly[]{std::byte{0x20}, std::byte{'a'}, std::byte{'b'}, std::byte{2}, std::byte{0}, std::byte{0x00}, std::byte{2}, std::byte{0}};
+        std::byte decoded[10]{};
+        Check(Archive::DecompressLZ4(matchOnly, sizeof(matchOnly), decoded, sizeof(decoded)), "Rejected a sequence without literals");
+        Check(std::memcmp(decoded, "ababababab", sizeof(decoded)) == 0, "Sequence without literals decoded incorrectly");
+
+        const std::byte leadingMatch[]{std::byte{0x00}, std::byte{1}, std::byte{0}};
+        Check(!Archive::DecompressLZ4(leadingMatch, sizeof(leadingMatch), nullptr, 0), "Accepted a match before any output");
+
+        std::cout << "AssetPacker round trip passed" << std::endl;
+        return 0;
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return 1;
+    }
+}